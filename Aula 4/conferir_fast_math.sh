@@ -0,0 +1,23 @@
+#!/bin/sh
+# compila o build preciso e o -DFAST_MATH, renderiza os mesmos cenários
+# com os dois e exige PSNR mínimo (padrão 50 dB) em cada um
+# uso: ./conferir_fast_math.sh [psnr_min]
+set -e
+cd "$(dirname "$0")"
+psnr=${1:-50}
+tmp=$(mktemp -d)
+trap 'rm -rf "$tmp"' EXIT
+
+g++ -std=c++17 -O2 -pthread main.cpp -o "$tmp/rt"
+g++ -std=c++17 -O2 -pthread -DFAST_MATH main.cpp -o "$tmp/rt_rapido"
+
+falhou=0
+i=0
+for opcoes in "" "--cena gerada --objetos 2000" "--luz-area retangulo" "--path --spp 4"; do
+    i=$((i + 1))
+    "$tmp/rt" $opcoes > "$tmp/preciso$i.ppm" 2>/dev/null
+    "$tmp/rt_rapido" $opcoes > "$tmp/rapido$i.ppm" 2>/dev/null
+    printf '%s: ' "${opcoes:-padrao}"
+    "$tmp/rt" --comparar "$tmp/preciso$i.ppm" --com "$tmp/rapido$i.ppm" --psnr-min "$psnr" || falhou=1
+done
+exit $falhou
@@ -3,6 +3,8 @@
 #include <iostream>
 #include <memory>
 #include <limits>
+#include <sstream>
+#include <stdexcept>
 
 #include "src/colors/color.h"
 #include "src/ray/ray.h"
@@ -13,75 +15,333 @@
 #include "src/objects/sphere.h"
 #include "src/objects/cone.h"
 #include "src/objects/plano.h"
+#include "src/objects/instance.h"
+#include "src/accel/bvh.h"
+#include "src/vectors/transform.h"
+#include "src/render/camera.h"
+#include "src/render/render_stats.h"
+#include "src/render/renderer.h"
+#include "src/render/ppm_stream.h"
+#include "src/render/progressive.h"
+#include "src/render/accumulator.h"
+#include "src/render/budget.h"
+#include "src/render/checkpoint.h"
+#include "src/render/numa.h"
+#include "src/render/batch.h"
+#include "src/render/temporal.h"
+#include "src/render/integrator.h"
+#include "src/render/path_tracer.h"
+#include "src/render/denoise.h"
+#include "src/render/shading.h"
+#include "src/render/shade_batch.h"
+#include "src/render/image_compare.h"
+#include "src/farm/farm.h"
+#include "src/farm/server.h"
+#include "src/scene/gerador.h"
+#include "src/scene/scene.h"
+#include "src/scene/cena_fixa.h"
+#include "src/lights/light.h"
+#include "src/bench/benchmark.h"
+#include "src/bench/kernel_check.h"
+#include "src/bench/regression.h"
+#include "src/util/args.h"
+#include "src/util/arquivo.h"
 #include "src/material/material.h"
+#include "src/util/rng.h"
+#include "src/sampling/sampler.h"
 
-// reflete v em torno de n
-vec3 reflect(const vec3& v, const vec3& n) {
-    return v - 2 * dot(v,n) * n;
+irradiance_record amostrar_hemisferio(const point3& p, const vec3& n, const scene& cena,
+                                      const indirect_settings& cfg);
+
+// soma à cor as luzes (pontuais e de área) que chegam ao ponto rec;
+// Especular e Sombra vêm dos traços do material e do objeto (shading.h)
+template <bool Especular, bool Sombra>
+color shade_lights(const ray& r, const hit_record& rec, const scene& cena, color cor) {
+    double tmin = 0.001;
+    const material& mat = *rec.mat;
+    vec3 n = rec.normal;
+    vec3 v = unit_vector(-r.direction());
+    point3 shadow_origin = rec.p + rec.normal * tmin;
+
+    for (const light& luz : cena.lights) {
+        if (!luz.is_area()) {
+            vec3 l = unit_vector(luz.position - rec.p);
+            double light_distance = (luz.position - rec.p).length();
+
+            // verificação de sombra, só contra os oclusores desta luz
+            if constexpr (Sombra) {
+                rays_traced()++;
+                if (luz.occluders->hit_any(ray(shadow_origin, l), tmin, light_distance))
+                    continue;
+            }
+
+            color I_d, I_e;
+            phong<Especular>(l, n, v, luz.intensity, mat.k_diffuse, mat.k_specular, mat.shininess, I_d, I_e);
+
+            cor = cor + I_d;
+            if constexpr (Especular) cor = cor + I_e;
+            continue;
+        }
+
+        // luz de área: uma fonte pontual por estrato, com intensidade
+        // dividida entre elas. as quatro dos cantos decidem se o ponto
+        // está na penumbra; fora dela, todas têm a mesma visibilidade
+        const int k = luz.grid;
+        color peso = luz.intensity / double(k * k);
+        std::uint64_t semente = point_seed(rec.p.x(), rec.p.y(), rec.p.z());
+
+        auto amostra = [&](int i, int j) {
+            rng g(semente ^ (std::uint64_t(j * k + i + 1) * 0x9e3779b97f4a7c15ull));
+            double su = g.uniform();
+            double sv = g.uniform();
+            return luz.sample(i, j, su, sv, rec.p);
+        };
+        auto visivel = [&](const point3& q) {
+            if constexpr (Sombra) {
+                vec3 d = q - rec.p;
+                double dist = d.length();
+                rays_traced()++;
+                return !luz.occluders->hit_any(ray(shadow_origin, d / dist), tmin, dist);
+            } else {
+                (void)q;
+                return true;
+            }
+        };
+
+        const int cantos[4][2] = {{0, 0}, {k - 1, 0}, {0, k - 1}, {k - 1, k - 1}};
+        bool vis_canto[4];
+        int acesos = 0;
+        for (int q = 0; q < 4; ++q) {
+            vis_canto[q] = visivel(amostra(cantos[q][0], cantos[q][1]));
+            acesos += vis_canto[q];
+        }
+        if (acesos == 0) continue;
+        bool penumbra = acesos < 4;
+
+        color I_d(0, 0, 0), I_e(0, 0, 0);
+        for (int j = 0; j < k; ++j) {
+            for (int i = 0; i < k; ++i) {
+                int q = (i == 0 || i == k - 1) && (j == 0 || j == k - 1)
+                      ? (i == 0 ? 0 : 1) + (j == 0 ? 0 : 2) : -1;
+                point3 p_luz = amostra(i, j);
+                bool vis = q >= 0 ? vis_canto[q] : !penumbra || visivel(p_luz);
+                if (!vis) continue;
+
+                vec3 l = unit_vector(p_luz - rec.p);
+                color d, e;
+                phong<Especular>(l, n, v, peso, mat.k_diffuse, mat.k_specular, mat.shininess, d, e);
+
+                I_d = I_d + d;
+                if constexpr (Especular) I_e = I_e + e;
+            }
+        }
+
+        cor = cor + I_d;
+        if constexpr (Especular) cor = cor + I_e;
+    }
+
+    return cor;
+}
+
+// cor local (ambiente + luzes, Phong) do ponto rec atingido pelo raio r
+// com 'indireto' falso, ignora o cache de irradiância (raios de coleta)
+color shade_hit(const ray& r, const hit_record& rec, const scene& cena, bool indireto = true) {
+    // componente ambiente
+    color cor = cena.ambient * rec.mat->k_ambient;
+
+    // oclusão ambiente e luz indireta: interpoladas do cache, ou
+    // calculadas na hora onde ele não cobre
+    if (indireto && cena.indirect) {
+        double ao;
+        color e;
+        if (!cena.indirect->lookup(rec.p, rec.normal, ao, e)) {
+            irradiance_record reg = amostrar_hemisferio(rec.p, rec.normal, cena, cena.indirect->settings);
+            ao = reg.ao;
+            e = reg.e;
+        }
+        cor = cor * ao + rec.mat->k_diffuse * e;
+    }
+
+    // um núcleo por combinação de traços do material e do objeto
+    using nucleo = color (*)(const ray&, const hit_record&, const scene&, color);
+    static constexpr nucleo nucleos[2][2] = {
+        {shade_lights<false, false>, shade_lights<false, true>},
+        {shade_lights<true, false>, shade_lights<true, true>},
+    };
+    return nucleos[rec.mat->specular()][rec.obj->receives_shadows](r, rec, cena, cor);
 }
 
-color ray_color(const ray& r, const hittable& world) {
+// se 'primario' não for nulo, recebe a interseção do raio primário
+// (primario->obj fica nulo quando o raio não atinge nada)
+color ray_color(const ray& r, const scene& cena, hit_record* primario = nullptr, bool indireto = true) {
     hit_record rec;
 
-    double tmin = 0.001;
-    if (!world.hit(r, tmin, std::numeric_limits<double>::infinity(), rec))
-        return color(0, 0, 0);
+    rays_traced()++;
+    if (!cena.world->hit(r, 0.001, std::numeric_limits<double>::infinity(), rec))
+        return cena.background;
 
-    point3 light_pos(0, 60, -30);
+    if (primario) *primario = rec;
 
-    // intensidade luz ambiente
-    color I_A(0.3, 0.3, 0.3);
-    // intensidade da fonte pontual
-    color I_F(0.7, 0.7, 0.7);
+    return shade_hit(r, rec, cena, indireto);
+}
 
-    // componente ambiente
-    color ambient_color = I_A * rec.mat->k_ambient;
-    
-    // verificação de sombra
-    vec3 l = unit_vector(light_pos - rec.p);
-    double light_distance = (light_pos - rec.p).length();
+// o sombreamento em lote só cobre luzes pontuais, sem cache de irradiância
+bool lote_suportado(const scene& cena) {
+    if (cena.indirect) return false;
+    for (const light& luz : cena.lights)
+        if (luz.is_area()) return false;
+    return true;
+}
 
-    point3 shadow_origin = rec.p + rec.normal * tmin;
-    ray shadow_ray(shadow_origin, l);
-    hit_record shadow_rec;
+std::vector<batch_light> luzes_do_lote(const scene& cena) {
+    std::vector<batch_light> luzes;
+    for (const light& luz : cena.lights) {
+        luzes.push_back({float(luz.position.x()), float(luz.position.y()), float(luz.position.z()),
+                         float(luz.intensity.x()), float(luz.intensity.y()), float(luz.intensity.z())});
+    }
+    return luzes;
+}
+
+// traça os raios primários e de sombra do tile t e junta no lote os
+// pontos atingidos (pixel = l * nCol + c); os que não atingem nada
+// ficam de fora (cor de fundo)
+void coletar_lote(const camera& cam, const scene& cena, const tile& t, hit_batch& lote) {
+    double tmin = 0.001;
+    lote.clear(int(cena.lights.size()));
+    for (int l = t.y0; l < t.y1; ++l) {
+        for (int c = t.x0; c < t.x1; ++c) {
+            ray r = cam.get_ray(c, l);
+            hit_record rec;
+            rays_traced()++;
+            if (!cena.world->hit(r, tmin, std::numeric_limits<double>::infinity(), rec)) continue;
+
+            const material& mat = *rec.mat;
+            int i = lote.add(l * cam.nCol + c, rec.p, rec.normal, r.direction(),
+                             mat.k_ambient, mat.k_diffuse, mat.k_specular, mat.shininess);
+
+            point3 shadow_origin = rec.p + rec.normal * tmin;
+            for (int k = 0; k < int(cena.lights.size()); ++k) {
+                const light& luz = cena.lights[k];
+                bool visivel = true;
+                if (rec.obj->receives_shadows) {
+                    vec3 d = luz.position - rec.p;
+                    rays_traced()++;
+                    visivel = !luz.occluders->hit_any(ray(shadow_origin, unit_vector(d)), tmin, d.length());
+                }
+                lote.set_visible(k, i, visivel);
+            }
+        }
+    }
+    lote.pad();
+}
+
+// luzes do cenário assado no ponto rec, com material I: traços e
+// brilho são constantes, então o pow sai desenrolado
+template <class Cena, std::size_t I>
+color shade_fixa(const ray& r, const baked_hit& rec) {
+    constexpr const baked_material& mat = Cena::materials[I];
+    constexpr bool especular = mat.specular();
+    double tmin = 0.001;
 
-    if (world.hit(shadow_ray, tmin, light_distance, shadow_rec))
-        return ambient_color;
+    color cor = Cena::ambient * mat.k_ambient;
 
     vec3 n = rec.normal;
     vec3 v = unit_vector(-r.direction());
-    vec3 rfl = reflect(-l, n);
+    point3 shadow_origin = rec.p + rec.normal * tmin;
+
+    for (std::size_t k = 0; k < Cena::lights.size(); ++k) {
+        const baked_light& luz = Cena::lights[k];
+        vec3 l = unit_vector(luz.position - rec.p);
+        double light_distance = (luz.position - rec.p).length();
 
-    double diff = std::max(0.0, dot(l, n));
-    double spec = pow(std::max(0.0, dot(v, rfl)), rec.mat->shininess);
+        rays_traced()++;
+        if (baked<Cena>::hit_any(ray(shadow_origin, l), tmin, light_distance, k))
+            continue;
 
-    color I_d = I_F * rec.mat->k_diffuse * diff;
-    color I_e = I_F * rec.mat->k_specular * spec;
+        color I_d, I_e;
+        phong<especular, mat.shininess>(l, n, v, luz.intensity, mat.k_diffuse, mat.k_specular,
+                                        mat.shininess, I_d, I_e);
 
-    return ambient_color + I_d + I_e;
+        cor = cor + I_d;
+        if constexpr (especular) cor = cor + I_e;
+    }
+
+    return cor;
 }
 
-int main() {
-    // propriedades da janela
-    auto wJanela = 60.0;
-    auto hJanela = 60.0;
-    auto dJanela = 30.0;
+// um núcleo por material, montado em tempo de compilação
+template <class Cena, std::size_t... I>
+constexpr auto nucleos_fixa(std::index_sequence<I...>) {
+    using nucleo = color (*)(const ray&, const baked_hit&);
+    return std::array<nucleo, sizeof...(I)>{{shade_fixa<Cena, I>...}};
+}
 
-    // olho do pintor
-    auto zoio = point3(0, 0, 0);
+// o mesmo ray_color (luzes pontuais, sem cache) para um cenário
+// assado em tempo de compilação: interseção desenrolada por tipo,
+// sem bvh, sem funções virtuais e sem shared_ptr
+template <class Cena>
+color ray_color_fixa(const ray& r) {
+    static constexpr auto nucleos = nucleos_fixa<Cena>(std::make_index_sequence<Cena::materials.size()>());
+    baked_hit rec;
 
-    int nCol = 500;
-    int nLin = 500;
+    rays_traced()++;
+    if (!baked<Cena>::hit(r, 0.001, std::numeric_limits<double>::infinity(), rec))
+        return color(0, 0, 0);
 
-    // tela de mosquito
-    auto Dx = wJanela / nCol;
-    auto Dy = hJanela / nLin;
-    
-    // arquivo ppm
-    std::cout << "P3\n" << nCol << ' ' << nLin << "\n255\n";
+    return nucleos[rec.mat](r, rec);
+}
+
+// grade x grade raios com distribuição de cosseno (estratificados) no
+// hemisfério de (p, n): fração livre até cfg.alcance, média harmônica
+// das distâncias e, com cfg.difusa, a irradiância de um rebote
+irradiance_record amostrar_hemisferio(const point3& p, const vec3& n, const scene& cena,
+                                      const indirect_settings& cfg) {
+    const double pi = 3.1415926535897932385;
+    const double tmin = 0.001;
+    vec3 a = std::fabs(n.x()) > 0.9 ? vec3(0, 1, 0) : vec3(1, 0, 0);
+    vec3 t1 = unit_vector(cross(a, n));
+    vec3 t2 = cross(n, t1);
+
+    rng g(point_seed(p.x(), p.y(), p.z()));
+    point3 origem = p + n * tmin;
+    int livres = 0;
+    double soma_inv = 0.0;
+    color soma_e(0, 0, 0);
+
+    for (int j = 0; j < cfg.grade; ++j) {
+        for (int i = 0; i < cfg.grade; ++i) {
+            double u1 = (i + g.uniform()) / cfg.grade;
+            double u2 = (j + g.uniform()) / cfg.grade;
+            double rr = std::sqrt(u1), phi = 2 * pi * u2;
+            vec3 d = rr * std::cos(phi) * t1 + rr * std::sin(phi) * t2 + std::sqrt(1 - u1) * n;
+
+            hit_record rec;
+            ray coleta(origem, d);
+            if (cfg.difusa) {
+                soma_e += ray_color(coleta, cena, &rec, false);
+            } else {
+                rays_traced()++;
+                cena.world->hit(coleta, tmin, std::numeric_limits<double>::infinity(), rec);
+            }
+
+            if (!rec.obj || rec.t > cfg.alcance) livres++;
+            if (rec.obj) soma_inv += 1.0 / std::max(rec.t, tmin);
+        }
+    }
+
+    int total = cfg.grade * cfg.grade;
+    irradiance_record reg;
+    reg.p = p;
+    reg.n = n;
+    reg.ao = double(livres) / total;
+    reg.e = soma_e / total;
+    reg.r = soma_inv > 0.0 ? total / soma_inv : std::numeric_limits<double>::infinity();
+    return reg;
+}
 
-    // mundo e objetos
-    hittable_list mundo;
+// mundo e objetos
+void montar_cena(scene& cena) {
+    hittable_list& mundo = cena.objects;
 
     auto material_esfera = std::make_shared<material>(
         // coeficiente ambiente
@@ -123,6 +383,8 @@ int main() {
 
     auto mat_chao = std::make_shared<material>(
         color(0.2, 0.7, 0.2), color(0.2, 0.7, 0.2), color(0.0, 0.0, 0.0), 1);
+    // chão levemente espelhado (só aparece com --integrador)
+    mat_chao->k_reflect = color(0.3, 0.3, 0.3);
 
     auto mat_fundo = std::make_shared<material>(
         color(0.3, 0.3, 0.7), color(0.3, 0.3, 0.7), color(0.0, 0.0, 0.0), 1);
@@ -131,7 +393,11 @@ int main() {
         std::make_shared<sphere>(point3(0,0,-100.0), R_esfera, material_esfera)
     );
     
-    mundo.add(
+    // haste (cilindro + cone) montada uma única vez como sub-cenário;
+    // o mundo só guarda instâncias dela
+    hittable_list haste;
+
+    haste.add(
         std::make_shared<cilindro>(
             C_esfera,                                    
             dr, 
@@ -147,7 +413,7 @@ int main() {
     double raio_base_cone = 1.5 * R_esfera;
     double altura_cone = raio_base_cone / 3.0;
 
-    mundo.add(
+    haste.add(
         std::make_shared<cone>(
             topo_cilindro,                                    
             dr, 
@@ -158,25 +424,751 @@ int main() {
         )
     );
 
+    auto haste_bvh = std::make_shared<bvh>(haste);
+    mundo.add(std::make_shared<instance>(haste_bvh, transform()));
+
     mundo.add(std::make_shared<plane>(point3(0, -R_esfera, 0), vec3(0, 1, 0), mat_chao));
     mundo.add(std::make_shared<plane>(point3(0, 0, -200), vec3(0, 0, 1), mat_fundo));
 
-    for (int l = 0; l < nLin; ++l) {
-        std::clog << "\rLinhas restantes: " << (nLin - l) << ' ' << std::flush;
-        for (int c = 0; c < nCol; ++c) {
-            auto x = -wJanela / 2.0 + Dx / 2.0 + c * Dx;
-            auto y =  hJanela / 2.0 - Dy / 2.0 - l * Dy;
-            
-            auto ponto_na_janela = point3(x, y, -dJanela);
+    // fonte pontual
+    cena.lights.push_back(light::point(point3(0, 60, -30), color(0.7, 0.7, 0.7)));
+}
+
+// cenários de referência da regressão, em res x res: as cenas das
+// aulas 2, 3 e 4 e cenários de estresse (luz de área, 2000 objetos).
+// a aula 2 não tinha sombras nem ambiente e tinha fundo cinza
+std::vector<regression_case> casos_de_regressao(thread_pool& pool, int res) {
+    auto caso = [&](const std::string& nome, camera cam, std::shared_ptr<scene> cena, bool fixa = false) {
+        cam.nCol = cam.nLin = res;
+        cena->build(cam.zoio);
+        regression_case c;
+        c.name = nome;
+        c.width = c.height = res;
+        c.render = [&pool, cam, cena, fixa](framebuffer& fb) {
+            return render_tiles(pool, fb, 16, [&](int col, int lin) {
+                if (fixa) return ray_color_fixa<cena_fixa>(cam.get_ray(col, lin));
+                return ray_color(cam.get_ray(col, lin), *cena);
+            });
+        };
+        return c;
+    };
+
+    std::vector<regression_case> casos;
+
+    auto aula2 = std::make_shared<scene>();
+    auto esfera = std::make_shared<sphere>(point3(0, 0, -9), 3.0, std::make_shared<material>(
+        color(0, 0, 0), color(1.0, 0.0, 0.0), color(1.0, 1.0, 1.0), 50));
+    esfera->receives_shadows = false;
+    aula2->objects.add(esfera);
+    aula2->lights.push_back(light::point(point3(0, 5, 0), color(0.7, 0.7, 0.7)));
+    aula2->ambient = color(0, 0, 0);
+    aula2->background = color(0.5, 0.5, 0.5);
+    casos.push_back(caso("aula2", camera(10.0, 10.0, 5.0, point3(0, 0, 0), res, res), aula2));
+
+    auto aula3 = std::make_shared<scene>();
+    aula3->objects.add(std::make_shared<sphere>(point3(0, 0, -100.0), 40.0, std::make_shared<material>(
+        color(0.7, 0.2, 0.2), color(0.7, 0.2, 0.2), color(0.7, 0.2, 0.2), 10)));
+    aula3->objects.add(std::make_shared<plane>(point3(0, -40.0, 0), vec3(0, 1, 0), std::make_shared<material>(
+        color(0.2, 0.7, 0.2), color(0.2, 0.7, 0.2), color(0.0, 0.0, 0.0), 1)));
+    aula3->objects.add(std::make_shared<plane>(point3(0, 0, -200), vec3(0, 0, 1), std::make_shared<material>(
+        color(0.3, 0.3, 0.7), color(0.3, 0.3, 0.7), color(0.0, 0.0, 0.0), 1)));
+    aula3->lights.push_back(light::point(point3(0, 60, -30), color(0.7, 0.7, 0.7)));
+    casos.push_back(caso("aula3", camera(), aula3));
 
-            auto ray_direction = ponto_na_janela - zoio;
+    auto aula4 = std::make_shared<scene>();
+    montar_cena(*aula4);
+    casos.push_back(caso("aula4", camera(), aula4));
+    casos.push_back(caso("aula4-fixa", camera(), aula4, true));
 
-            ray r(zoio, ray_direction);
-            
-            color pixel_color = ray_color(r, mundo);
-            write_color(std::cout, pixel_color);
+    auto area = std::make_shared<scene>();
+    montar_cena(*area);
+    for (auto& luz : area->lights)
+        luz = light::rectangle(luz.position, vec3(20, 0, 0), vec3(0, 0, 20), luz.intensity, 4);
+    casos.push_back(caso("luz-area", camera(), area));
+
+    casos.push_back(caso("gerada-2000", camera(), std::make_shared<scene>(gerar_cena(2000, 42))));
+    return casos;
+}
+
+// limite de --objetos e --bench --n: um valor negativo viraria um
+// size_t enorme e o processo morreria sem memória
+const long long max_objetos = 10000000;
+
+// cenário escolhido na linha de comando:
+// --cena padrao (o de sempre) ou --cena gerada [--objetos n] [--seed s]
+// --luz-area retangulo|disco|esfera [--luz-tamanho d] [--luz-grade k]
+// troca as fontes pontuais por luzes de área com o mesmo centro
+// o cenário volta sem build()
+scene construir_mundo(const args& opcoes) {
+    scene cena;
+    if (opcoes.get("--cena", "padrao") == "gerada") {
+        long long n = opcoes.get_int("--objetos", 1000);
+        if (n < 1 || n > max_objetos) throw std::runtime_error("--objetos fora de 1.." + std::to_string(max_objetos));
+        cena = gerar_cena(std::size_t(n), std::uint64_t(opcoes.get_int("--seed", 42)));
+    } else
+        montar_cena(cena);
+
+    if (opcoes.has("--luz-area")) {
+        std::string forma = opcoes.get("--luz-area", "retangulo");
+        double d = opcoes.get_double("--luz-tamanho", 20.0);
+        int k = int(opcoes.get_int("--luz-grade", 4));
+        for (auto& luz : cena.lights) {
+            if (luz.is_area()) continue;
+            light area = forma == "disco"  ? light::disk(luz.position, vec3(0, -1, 0), d / 2, luz.intensity, k)
+                       : forma == "esfera" ? light::sphere(luz.position, d / 2, luz.intensity, k)
+                       : light::rectangle(luz.position, vec3(d, 0, 0), vec3(0, 0, d), luz.intensity, k);
+            area.linked = luz.linked;
+            luz = area;
         }
     }
+    return cena;
+}
+
+// opções lidas por construir_mundo: a chave do cache do servidor e o
+// que a fazenda repassa aos trabalhadores saem desta mesma lista
+const std::vector<std::string> opcoes_de_cenario = {
+    "--cena", "--objetos", "--seed", "--luz-area", "--luz-tamanho", "--luz-grade"};
+
+// opções que mudam o sombreamento de um cenário já montado
+const std::vector<std::string> opcoes_de_sombreamento = {
+    "--ambiente", "--ic-grade", "--ic-erro", "--ic-alcance", "--ic-forca-bruta", "--amostrador"};
+
+// as opções de 'nomes' presentes, com o valor quando houver um
+// (opções sem valor, como --ic-forca-bruta, vão sozinhas)
+std::vector<std::string> opcoes_presentes(const args& opcoes, const std::vector<std::string>& nomes) {
+    std::vector<std::string> out;
+    for (const auto& nome : nomes) {
+        if (!opcoes.has(nome)) continue;
+        out.push_back(nome);
+        std::string valor = opcoes.get(nome);
+        if (!valor.empty() && valor.rfind("--", 0) != 0) out.push_back(valor);
+    }
+    return out;
+}
+
+// pedidos ao servidor: as opções de cenário da linha de comando mais
+// câmera (--res, --olho x,y,z) e qualidade (--spp)
+std::string chave_do_cenario(const args& opcoes) {
+    std::vector<std::string> nomes = opcoes_de_cenario;
+    nomes.push_back("--olho");
+    std::string chave;
+    for (const auto& op : opcoes_presentes(opcoes, nomes)) chave += op + ' ';
+    return chave;
+}
+
+// para onde olham as câmeras que giram em volta do cenário padrão
+const point3 centro_do_cenario(0, 0, -100);
+
+// maior raio (até 'raio') em que o giro de --lote-giro fica do mesmo lado
+// de cada plano que o centro, com 10% de folga: com o raio cheio, uma das
+// câmeras do cenário padrão ficaria em cima do fundo (z = -200)
+double raio_do_giro(const scene& cena, const point3& centro, double raio, double altura) {
+    for (const auto& obj : cena.objects.objects) {
+        auto p = std::dynamic_pointer_cast<plane>(obj);
+        if (!p) continue;
+        const vec3& n = p->get_normal();
+        // distância do centro do círculo ao plano e quanto dela o raio come
+        double d = std::abs(dot(centro + vec3(0, altura, 0) - p->get_point(), n));
+        double horizontal = std::sqrt(n.x() * n.x() + n.z() * n.z());
+        if (horizontal > 1e-9) raio = std::min(raio, 0.9 * d / horizontal);
+    }
+    return raio;
+}
+
+camera camera_do_pedido(const args& opcoes) {
+    camera cam;
+    long long res = opcoes.get_int("--res", 500);
+    if (res < 1 || res > 4096) throw std::runtime_error("--res fora de 1..4096");
+    cam.nCol = cam.nLin = int(res);
+    if (opcoes.has("--olho")) {
+        double x, y, z;
+        char v1, v2;
+        std::istringstream ss(opcoes.get("--olho"));
+        if (!(ss >> x >> v1 >> y >> v2 >> z) || v1 != ',' || v2 != ',')
+            throw std::runtime_error("--olho espera x,y,z");
+        // a janela gira junto com o olho: mover só o olho com a janela
+        // parada em z = -30 entortaria a imagem
+        vec3 para_o_centro = centro_do_cenario - point3(x, y, z);
+        if (cross(vec3(0, 1, 0), para_o_centro).length() < 1e-6)
+            throw std::runtime_error("--olho não pode estar na vertical do centro do cenário");
+        cam.look_at(point3(x, y, z), centro_do_cenario);
+    }
+    return cam;
+}
+
+// um pedido ruim vira ERROR para o cliente em vez de derrubar o servidor
+// (--objetos já é conferido em construir_mundo)
+void conferir_cenario_do_pedido(const args& opcoes) {
+    std::string nome = opcoes.get("--cena", "padrao");
+    if (nome != "padrao" && nome != "gerada") throw std::runtime_error("--cena desconhecida: " + nome);
+    if (opcoes.has("--luz-area")) {
+        std::string forma = opcoes.get("--luz-area", "retangulo");
+        if (forma != "retangulo" && forma != "disco" && forma != "esfera")
+            throw std::runtime_error("--luz-area desconhecida: " + forma);
+        double d = opcoes.get_double("--luz-tamanho", 20.0);
+        if (!(d > 0 && d <= 1000)) throw std::runtime_error("--luz-tamanho fora de (0, 1000]");
+        long long k = opcoes.get_int("--luz-grade", 4);
+        if (k < 1 || k > 64) throw std::runtime_error("--luz-grade fora de 1..64");
+    }
+}
+
+server_handlers servicos(thread_pool& pool) {
+    server_handlers h;
+    h.scene_key = chave_do_cenario;
+    h.build = [](const args& opcoes) {
+        conferir_cenario_do_pedido(opcoes);
+        auto cena = std::make_shared<scene>(construir_mundo(opcoes));
+        cena->build(camera_do_pedido(opcoes).zoio);
+        return std::shared_ptr<const scene>(cena);
+    };
+    h.render = [&pool](const args& opcoes, const scene& cena, framebuffer& fb) {
+        camera cam = camera_do_pedido(opcoes);
+        long long spp = opcoes.get_int("--spp", 1);
+        if (spp < 1 || spp > 1024) throw std::runtime_error("--spp fora de 1..1024");
+        fb = framebuffer(cam.nCol, cam.nLin);
+        return render_tiles(pool, fb, 16, [&](int c, int l) {
+            return sample_pixel(c, l, int(spp), [&](int pc, int pl, double su, double sv) {
+                return ray_color(cam.get_ray(pc, pl, su, sv), cena);
+            });
+        });
+    };
+    return h;
+}
+
+// oclusão ambiente (e luz indireta difusa) com cache de irradiância
+// --ambiente ao|indireto [--ic-grade g] [--ic-erro e] [--ic-alcance d]
+// [--ic-forca-bruta] calcula em todo ponto, sem cache, para comparar
+// o cache é preenchido com 'pool' para a vista de 'cam'
+void preparar_sombreamento(const args& opcoes, thread_pool& pool, const camera& cam, scene& cena) {
+    if (!opcoes.has("--ambiente")) return;
+
+    auto ic = std::make_shared<irradiance_cache>(opcoes.get_double("--ic-erro", 0.3));
+    ic->settings.grade = int(opcoes.get_int("--ic-grade", 8));
+    ic->settings.alcance = opcoes.get_double("--ic-alcance", 80.0);
+    ic->settings.difusa = opcoes.get("--ambiente", "ao") == "indireto";
+
+    if (!opcoes.has("--ic-forca-bruta")) {
+        auto inicio = std::chrono::steady_clock::now();
+        size_t n = ic->populate(pool, cam.nCol, cam.nLin, [&](int c, int l, point3& p, vec3& nrm) {
+            hit_record rec;
+            if (!cena.world->hit(cam.get_ray(c, l), 0.001, std::numeric_limits<double>::infinity(), rec))
+                return false;
+            p = rec.p;
+            nrm = rec.normal;
+            return true;
+        }, [&](const point3& p, const vec3& nrm) {
+            return amostrar_hemisferio(p, nrm, cena, ic->settings);
+        });
+        long long por_registro = (long long)ic->settings.grade * ic->settings.grade;
+        std::clog << "cache de irradiância: " << n << " registros, " << n * por_registro
+                  << " raios de coleta (força bruta: " << (long long)cam.nCol * cam.nLin * por_registro
+                  << "), " << elapsed_ms(inicio) << " ms\n";
+    }
+    cena.indirect = ic;
+}
+
+// caminho deste executável, para iniciar os trabalhadores da fazenda
+std::string caminho_executavel(const char* argv0) {
+#ifdef __linux__
+    char buf[4096];
+    ssize_t n = readlink("/proc/self/exe", buf, sizeof(buf) - 1);
+    if (n > 0) return std::string(buf, size_t(n));
+#endif
+    return argv0;
+}
+
+int main(int argc, char* argv[]) try {
+    args opcoes(argc, argv);
+
+    // vale para todos os modos que dividem a imagem em tiles
+    long long lado_tile = opcoes.get_int("--tile", 16);
+    if (lado_tile < 1 || lado_tile > 4096) throw std::runtime_error("--tile fora de 1..4096");
+
+    // curva de escala com o cenário procedural:
+    // --bench [--n 10,100,...] [--threads 1,2,...] [--seed s] [--res px]
+    if (opcoes.has("--bench")) {
+        bench_config cfg;
+        if (!opcoes.get("--n").empty()) {
+            cfg.ns.clear();
+            for (auto n : opcoes.get_list("--n")) {
+                if (n < 1 || n > max_objetos) throw std::runtime_error("--n fora de 1.." + std::to_string(max_objetos));
+                cfg.ns.push_back(std::size_t(n));
+            }
+        }
+        for (auto t : opcoes.get_list("--threads")) cfg.threads.push_back(int(t));
+        cfg.seed = std::uint64_t(opcoes.get_int("--seed", 42));
+        cfg.resolution = int(opcoes.get_int("--res", 256));
+
+        run_scaling_bench(cfg, [](const ray& r, const scene& cena) {
+            return ray_color(r, cena);
+        }, std::cout);
+        return 0;
+    }
+
+    // compara duas imagens: --comparar referencia.ppm --com imagem.ppm
+    // [--psnr-min db] [--erro-max n]; sai com 1 se passar do limite
+    // (p.ex. o build com -DFAST_MATH contra o preciso)
+    if (opcoes.has("--comparar")) {
+        std::ifstream fa(opcoes.get("--comparar")), fb(opcoes.get("--com"));
+        ppm_image a, b;
+        if (!read_ppm(fa, a) || !read_ppm(fb, b)) {
+            std::clog << "não consegui ler as duas imagens\n";
+            return 1;
+        }
+        image_diff d = compare_images(a, b);
+        if (!d.same_size) {
+            std::clog << "tamanhos diferentes: " << a.width << 'x' << a.height << " e "
+                      << b.width << 'x' << b.height << '\n';
+            return 1;
+        }
+        double psnr_min = opcoes.get_double("--psnr-min", 0.0);
+        int erro_max = int(opcoes.get_int("--erro-max", std::numeric_limits<int>::max()));
+        bool ok = d.psnr >= psnr_min && d.max_error <= erro_max;
+        std::cout << "psnr: " << d.psnr << " dB, erro máximo: " << d.max_error
+                  << ", canais diferentes: " << d.differing << " de " << a.values.size()
+                  << (ok ? "" : "  FALHOU") << '\n';
+        return ok ? 0 : 1;
+    }
+
+    // validação diferencial dos núcleos de interseção (assado, instância,
+    // bvh, sombra) contra o hit() das classes, com raios aleatórios e
+    // adversariais; --validar-nucleos [--raios n por categoria]
+    // [--seed s] [--repeticoes n]; sai com 1 se alguma variante divergir
+    if (opcoes.has("--validar-nucleos")) {
+        bool ok = run_kernel_check(std::size_t(opcoes.get_int("--raios", 200000)),
+                                   std::uint64_t(opcoes.get_int("--seed", 42)),
+                                   int(opcoes.get_int("--repeticoes", 3)), std::cout);
+        return ok ? 0 : 1;
+    }
+
+    // janela, olho e resolução
+    camera cam;
+
+    // nível de cima: bvh sobre os objetos e instâncias do mundo,
+    // mais as estruturas de oclusão de cada luz
+    scene cena = construir_mundo(opcoes);
+    cena.build(cam.zoio);
+
+    // threads fixadas nos núcleos e uma cópia do cenário por nó NUMA
+    // --numa [--threads-por-no n]; cada réplica recebe o mesmo
+    // sombreamento do caminho normal. vem antes do pool global, que
+    // ficaria parado ao lado das threads de cada nó
+    if (opcoes.has("--numa")) {
+        framebuffer fb(cam.nCol, cam.nLin);
+        auto stats = numa_render(fb, int(opcoes.get_int("--tile", 16)),
+            int(opcoes.get_int("--threads-por-no", 0)),
+            [&](int threads) {
+                auto replica = std::make_shared<scene>(construir_mundo(opcoes));
+                replica->build(cam.zoio);
+                // cache de irradiância próprio, preenchido pelas threads do nó
+                if (opcoes.has("--ambiente")) {
+                    thread_pool local(threads);
+                    preparar_sombreamento(opcoes, local, cam, *replica);
+                }
+                return replica;
+            },
+            [&](const scene& replica, int c, int l) { return ray_color(cam.get_ray(c, l), replica); });
+
+        fb.write_ppm(std::cout);
+        std::clog << "no\tthreads\ttiles\troubados\traios\traios_por_s\n";
+        for (const auto& st : stats) {
+            // um nó sem tiles não mediu tempo: vazão 0
+            double seg = st.busy_ms / 1000.0;
+            std::clog << st.node << '\t' << st.threads << '\t' << st.tiles << '\t' << st.stolen << '\t'
+                      << st.rays << '\t' << (long long)(seg > 0 ? st.rays / seg : 0.0) << '\n';
+        }
+        return 0;
+    }
+
+    thread_pool pool(int(opcoes.get_int("--threads", thread_pool::default_size())));
+
+    // regressão: cenários de referência contra imagens de ouro e tempos base
+    // --regressao [dir] [--gravar] [--psnr-min db] [--erro-max n]
+    // [--lentidao-max x] [--repeticoes n] [--res px]
+    // sai com 1 em qualquer regressão de qualidade ou de velocidade
+    if (opcoes.has("--regressao")) {
+        regression_config rc;
+        std::string dir = opcoes.get("--regressao");
+        if (!dir.empty() && dir.rfind("--", 0) != 0) rc.dir = dir;
+        rc.record = opcoes.has("--gravar");
+        rc.psnr_min = opcoes.get_double("--psnr-min", rc.psnr_min);
+        rc.max_error = int(opcoes.get_int("--erro-max", rc.max_error));
+        rc.slowdown_max = opcoes.get_double("--lentidao-max", rc.slowdown_max);
+        rc.repeats = int(opcoes.get_int("--repeticoes", rc.repeats));
+        auto casos = casos_de_regressao(pool, int(opcoes.get_int("--res", 128)));
+        return run_regression(rc, casos, std::cout) ? 0 : 1;
+    }
+
+    // serviço de renderização: --servidor [socket] [--cache-cenas n]
+    // sem caminho, atende pelo stdin/stdout (protocolo em src/farm/server.h)
+    if (opcoes.has("--servidor")) {
+        render_server servidor(servicos(pool), std::size_t(opcoes.get_int("--cache-cenas", 4)));
+        std::string caminho = opcoes.get("--servidor");
+        if (caminho.empty() || caminho.rfind("--", 0) == 0) return servidor.serve_stdio();
+        return servidor.serve_unix(caminho);
+    }
+
+    // a reprojeção de --sequencia só vale com iluminação direta: raios de
+    // oclusão, luz indireta e o cache de irradiância passam longe das
+    // caixas testadas pelo temporal_cache
+    if (opcoes.has("--sequencia") && (opcoes.has("--ambiente") || opcoes.has("--path"))) {
+        std::cerr << "--sequencia não funciona com --ambiente nem com --path\n";
+        return 1;
+    }
+
+    preparar_sombreamento(opcoes, pool, cam, cena);
+
+    // erro de cada amostrador com o mesmo spp, contra uma referência
+    // --bench-amostradores [--spp 1,4,16,64] [--spp-ref n] [--res px]
+    if (opcoes.has("--bench-amostradores")) {
+        sampler_bench_config cfg;
+        if (!opcoes.get("--spp").empty()) {
+            cfg.spps.clear();
+            for (auto n : opcoes.get_list("--spp")) cfg.spps.push_back(int(n));
+        }
+        cfg.reference_spp = int(opcoes.get_int("--spp-ref", 1024));
+        cfg.resolution = int(opcoes.get_int("--res", 128));
+
+        run_sampler_bench(cfg, pool, [&](const camera& c_cam, int c, int l, double su, double sv) {
+            return ray_color(c_cam.get_ray(c, l, su, sv), cena);
+        }, std::cout);
+        return 0;
+    }
+
+    // sombreamento em lote (SoA) de cada conjunto de instruções contra a
+    // referência escalar em double, só a parte de Phong
+    // --bench-sombreamento [--repeticoes n]
+    if (opcoes.has("--bench-sombreamento")) {
+        if (!lote_suportado(cena)) {
+            std::clog << "o sombreamento em lote só cobre luzes pontuais sem --ambiente\n";
+            return 1;
+        }
+        hit_batch lote;
+        auto inicio = std::chrono::steady_clock::now();
+        coletar_lote(cam, cena, tile{0, 0, cam.nCol, cam.nLin}, lote);
+        std::cout << "coleta (raios primários e de sombra): " << elapsed_ms(inicio) << " ms\n";
+        run_shading_bench(lote, luzes_do_lote(cena), cena.ambient,
+                          int(opcoes.get_int("--repeticoes", 20)), std::cout);
+        return 0;
+    }
+
+    // trabalhador da fazenda: recebe tiles pelo stdin, devolve pixels pelo stdout
+    // com --amostrador, as posições no pixel vêm dele (o spp é o do pedido)
+    if (opcoes.has("--worker")) {
+        std::unique_ptr<sampler> amostrador;
+        if (opcoes.has("--amostrador"))
+            amostrador = std::make_unique<sampler>(sampler::parse(opcoes.get("--amostrador")),
+                                                   int(opcoes.get_int("--spp", 1)));
+        return farm_worker_main(pool, [&](int c, int l, double su, double sv) {
+            return ray_color(cam.get_ray(c, l, su, sv), cena);
+        }, amostrador.get());
+    }
+
+    // fazenda local: --farm n [--spp s] [--tile px]
+    // cada trabalhador monta o mesmo cenário e sombreamento: recebe as
+    // opções de opcoes_de_cenario e opcoes_de_sombreamento
+    if (opcoes.has("--farm")) {
+        farm_config fc;
+        long long trabalhadores = opcoes.get_int("--farm", 2);
+        if (trabalhadores < 1 || trabalhadores > 256) throw std::runtime_error("--farm fora de 1..256");
+        fc.workers = int(trabalhadores);
+        fc.tile_size = int(opcoes.get_int("--tile", 32));
+        fc.spp = int(opcoes.get_int("--spp", 1));
+        // nome errado acusado aqui, não em cada trabalhador
+        if (opcoes.has("--amostrador")) sampler::parse(opcoes.get("--amostrador"));
+        fc.exe = caminho_executavel(argv[0]);
+        for (const auto* nomes : {&opcoes_de_cenario, &opcoes_de_sombreamento})
+            for (const auto& op : opcoes_presentes(opcoes, *nomes))
+                fc.worker_args.push_back(op);
+        fc.worker_args.push_back("--spp");
+        fc.worker_args.push_back(std::to_string(fc.spp));
+        fc.worker_args.push_back("--threads");
+        fc.worker_args.push_back(opcoes.get("--worker-threads", "1"));
+
+        framebuffer fb(cam.nCol, cam.nLin);
+        if (!farm_render(fc, fb, std::clog)) return 1;
+        fb.write_ppm(std::cout);
+        return 0;
+    }
+
+    // prévia progressiva: 1/8, 1/4, 1/2 e resolução cheia,
+    // regravando o arquivo depois de cada passada
+    if (opcoes.has("--progressivo")) {
+        std::string caminho = opcoes.get("--progressivo", "previa.ppm");
+        if (caminho.rfind("--", 0) == 0) caminho = "previa.ppm";
+        auto inicio = std::chrono::steady_clock::now();
+
+        render_progressive(pool, cam.nCol, cam.nLin, [&](int c, int l) {
+            return ray_color(cam.get_ray(c, l), cena);
+        }, [&](const framebuffer& previa, int passo) {
+            write_file_atomic(caminho, [&](std::ostream& out) { previa.write_ppm(out); });
+            std::clog << "passada 1/" << passo << ": " << elapsed_ms(inicio) << " ms\n";
+        });
+        return 0;
+    }
+
+    // orçamento de tempo: imagem grossa completa primeiro, depois
+    // refinamento adaptativo até o prazo; a melhor imagem vai para a saída
+    // --orcamento ms [--spp-max n]
+    if (opcoes.has("--orcamento")) {
+        auto inicio = std::chrono::steady_clock::now();
+        auto prazo = inicio + std::chrono::milliseconds(opcoes.get_int("--orcamento", 1000));
+        int tile_size = int(opcoes.get_int("--tile", 16));
+
+        accumulator acc(cam.nCol, cam.nLin);
+        budget_result res = render_budget(pool, acc, tile_size, prazo,
+            [&](int c, int l, double su, double sv, int) {
+                return ray_color(cam.get_ray(c, l, su, sv), cena);
+            }, int(opcoes.get_int("--spp-max", 64)));
+
+        acc.resolve().write_ppm(std::cout);
+        std::clog << "passadas: " << res.passes
+                  << ", spp médio: " << res.mean_spp
+                  << ", raios: " << res.rays
+                  << (res.converged ? ", convergiu" : ", prazo esgotado")
+                  << " (" << elapsed_ms(inicio) << " ms)\n";
+        return 0;
+    }
+
+    // checkpoints periódicos da acumulação e dos tiles terminados
+    // --checkpoint arquivo [--checkpoint-intervalo s] [--resume] [--spp n]
+    if (opcoes.has("--checkpoint")) {
+        checkpoint_config ck;
+        ck.path = opcoes.get("--checkpoint", "render.ckpt");
+        double intervalo = opcoes.get_double("--checkpoint-intervalo", 30.0);
+        if (!(intervalo > 0)) {
+            std::cerr << "--checkpoint-intervalo precisa ser maior que zero\n";
+            return 1;
+        }
+        ck.interval = std::chrono::milliseconds((long long)std::ceil(1000 * intervalo));
+        ck.resume = opcoes.has("--resume");
+        for (const auto* nomes : {&opcoes_de_cenario, &opcoes_de_sombreamento})
+            for (const auto& op : opcoes_presentes(opcoes, *nomes)) ck.scene_key += op + ' ';
+
+        bool ok = render_checkpointed(pool, cam.nCol, cam.nLin, int(opcoes.get_int("--tile", 16)),
+            int(opcoes.get_int("--spp", 1)), ck, std::cout, [&](int c, int l, double su, double sv) {
+                return ray_color(cam.get_ray(c, l, su, sv), cena);
+            });
+        return ok ? 0 : 1;
+    }
+
+    // sequência animada com câmera parada: as primeiras --animados esferas
+    // oscilam em x e só os pixels afetados pelo movimento são retraçados
+    // --sequencia quadros [--animados k] [--prefixo caminho/quadro_]
+    // (--ambiente e --path são recusados antes de montar o cache de irradiância)
+    if (opcoes.has("--sequencia")) {
+        int quadros = int(opcoes.get_int("--sequencia", 24));
+        std::size_t k = std::size_t(opcoes.get_int("--animados", 1));
+        std::string prefixo = opcoes.get("--prefixo", "quadro_");
+
+        std::vector<std::shared_ptr<sphere>> animadas;
+        std::vector<point3> bases;
+        for (const auto& obj : cena.objects.objects) {
+            if (animadas.size() >= k) break;
+            if (auto esf = std::dynamic_pointer_cast<sphere>(obj)) {
+                animadas.push_back(esf);
+                bases.push_back(esf->get_center());
+            }
+        }
+
+        std::vector<aabb> luzes;
+        for (const auto& luz : cena.lights) luzes.push_back(luz.bounding_box());
+
+        temporal_cache cache(cam.nCol, cam.nLin);
+        framebuffer fb(cam.nCol, cam.nLin);
+        for (int f = 0; f < quadros; ++f) {
+            auto inicio = std::chrono::steady_clock::now();
+
+            std::vector<aabb> movidos;
+            for (size_t i = 0; i < animadas.size(); ++i) {
+                aabb antes = animadas[i]->bounding_box();
+                double ang = 2.0 * 3.1415926535897932385 * f / quadros;
+                animadas[i]->set_center(bases[i] + vec3(animadas[i]->get_radius() * std::sin(ang), 0, 0));
+                movidos.push_back(aabb(antes, animadas[i]->bounding_box()).padded(0.01));
+            }
+            cena.update();
+
+            std::size_t retracados = cache.render_frame(pool, cam, luzes, movidos, fb,
+                [&](const ray& r, hit_record& rec) { return ray_color(r, cena, &rec); });
+
+            char nome[32];
+            std::snprintf(nome, sizeof(nome), "%04d.ppm", f);
+            write_file_atomic(prefixo + nome, [&](std::ostream& out) { fb.write_ppm(out); });
+            std::clog << "quadro " << f << ": " << retracados << " de " << fb.pixels.size()
+                      << " pixels retraçados, " << elapsed_ms(inicio) << " ms\n";
+        }
+        return 0;
+    }
+
+    // várias vistas do mesmo cenário, construído uma vez só
+    // --lote cameras.txt | --lote-giro n, [--prefixo caminho/vista_]
+    if (opcoes.has("--lote") || opcoes.has("--lote-giro")) {
+        std::vector<camera_def> vistas;
+        if (opcoes.has("--lote-giro")) {
+            double raio = raio_do_giro(cena, centro_do_cenario, 100.0, 0.0);
+            if (raio < 100.0) std::clog << "giro com raio " << raio << " para ficar na frente dos planos\n";
+            vistas = turntable(int(opcoes.get_int("--lote-giro", 8)), centro_do_cenario, raio, 0.0);
+        } else {
+            std::ifstream arq(opcoes.get("--lote"));
+            vistas = read_camera_list(arq);
+        }
+        if (vistas.empty()) {
+            std::clog << "nenhuma câmera no lote\n";
+            return 1;
+        }
+
+        // os planos que não fazem sombra dependem dos olhos de todas as vistas
+        std::vector<point3> olhos;
+        for (const auto& v : vistas) olhos.push_back(v.cam.zoio);
+        cena.build(olhos);
+
+        std::string prefixo = opcoes.get("--prefixo", "vista_");
+        auto inicio = std::chrono::steady_clock::now();
+        std::uint64_t raios = render_batch(pool, vistas, int(opcoes.get_int("--tile", 16)),
+            [&](const camera& c_cam, int c, int l) { return ray_color(c_cam.get_ray(c, l), cena); },
+            [&](int i, const framebuffer& fb) {
+                write_file_atomic(prefixo + vistas[i].name + ".ppm", [&](std::ostream& out) { fb.write_ppm(out); });
+            });
+
+        double ms = elapsed_ms(inicio);
+        std::clog << vistas.size() << " vistas em " << ms << " ms ("
+                  << ms / vistas.size() << " ms por vista, " << raios << " raios)\n";
+        return 0;
+    }
+
+    // path tracing progressivo com amostragem direta das luzes e MIS
+    // --path [--spp n] [--amostrador nome] [--profundidade-max n]
+    // [--escala-luz x] [--sem-nee] [--previa arquivo [--previa-cada k]]
+    // [--denoise [--denoise-passadas n]] filtra a imagem final com o g-buffer
+    if (opcoes.has("--path")) {
+        path_settings pcfg;
+        pcfg.max_depth = int(opcoes.get_int("--profundidade-max", pcfg.max_depth));
+        pcfg.light_scale = opcoes.get_double("--escala-luz", pcfg.light_scale);
+        pcfg.nee = !opcoes.has("--sem-nee");
+        long long spp_pedido = opcoes.get_int("--spp", 16);
+        if (spp_pedido < 1 || spp_pedido > 65536) throw std::runtime_error("--spp fora de 1..65536");
+        int spp = int(spp_pedido);
+        sampler amostrador(sampler::parse(opcoes.get("--amostrador", "sobol")), spp);
+        path_tracer pt(cena, amostrador, pcfg);
+
+        std::string previa = opcoes.get("--previa");
+        int cada = int(opcoes.get_int("--previa-cada", 4));
+        auto inicio = std::chrono::steady_clock::now();
+
+        accumulator acc(cam.nCol, cam.nLin);
+        gbuffer gb(cam.nCol, cam.nLin);
+        std::uint64_t raios = render_accumulate(pool, acc, gb, int(opcoes.get_int("--tile", 16)), spp,
+            [&](int c, int l, int amostra, hit_record& rec) {
+                double su, sv;
+                amostrador.get_2d(c, l, amostra, 0, su, sv);
+                return pt.trace(cam.get_ray(c, l, su, sv), c, l, amostra, &rec);
+            },
+            [&](const accumulator& a, int passada) {
+                if (!previa.empty() && (passada % cada == 0 || passada == spp))
+                    write_file_atomic(previa, [&](std::ostream& out) { a.resolve().write_ppm(out); });
+                std::clog << "\rpassada " << passada << "/" << spp << ' ' << std::flush;
+            });
+
+        std::clog << "\r" << spp << " spp, " << raios << " raios, " << elapsed_ms(inicio) << " ms\n";
+        if (opcoes.has("--denoise")) {
+            denoise_settings dcfg;
+            dcfg.iterations = int(opcoes.get_int("--denoise-passadas", dcfg.iterations));
+            inicio = std::chrono::steady_clock::now();
+            denoise(pool, acc, gb, dcfg).write_ppm(std::cout);
+            std::clog << "filtro: " << elapsed_ms(inicio) << " ms\n";
+        } else {
+            acc.resolve().write_ppm(std::cout);
+        }
+        return 0;
+    }
+
+    // renderização paralela em tiles; o arquivo ppm sai em faixas
+    // de linhas, em ordem, à medida que ficam prontas
+    // [--spp n --amostrador independente|estratificado|sobol|ruido-azul]
+    int tile_size = int(opcoes.get_int("--tile", 16));
+    sampler amostrador(sampler::parse(opcoes.get("--amostrador", "independente")),
+                       int(opcoes.get_int("--spp", 1)));
+
+    framebuffer fb(cam.nCol, cam.nLin);
+    ppm_stream_writer saida(std::cout, cam.nCol, cam.nLin, tile_size);
+    saida.on_band_written = [&](int escritas, int) {
+        int linhas = std::min(escritas * tile_size, cam.nLin);
+        std::clog << "\rLinhas restantes: " << (cam.nLin - linhas) << ' ' << std::flush;
+    };
+
+    // reflexão e refração: --integrador [--profundidade n]
+    // [--orcamento-raios n por pixel] [--limiar-peso x] [--spp n]
+    bool integrador = opcoes.has("--integrador");
+    integrator_settings icfg;
+    icfg.max_depth = int(opcoes.get_int("--profundidade", icfg.max_depth));
+    icfg.ray_budget = int(opcoes.get_int("--orcamento-raios", icfg.ray_budget));
+    icfg.min_throughput = opcoes.get_double("--limiar-peso", icfg.min_throughput);
+    path_stats caminhos;
+
+    // --cena fixa: o cenário padrão assado em tempo de compilação
+    // (src/scene/cena_fixa.h), só com a câmera padrão
+    bool fixa = opcoes.get("--cena", "padrao") == "fixa";
+
+    auto amostra = [&](int c, int l, double su, double sv) {
+        if (fixa) return ray_color_fixa<cena_fixa>(cam.get_ray(c, l, su, sv));
+        return ray_color(cam.get_ray(c, l, su, sv), cena);
+    };
+    // --simd [auto|escalar|avx2|avx512]: um tile por lote, com o Phong
+    // vetorizado (shade_batch.h); só com 1 spp e luzes pontuais
+    bool simd = opcoes.has("--simd") && !integrador && amostrador.samples_per_pixel() == 1;
+    if (simd && !lote_suportado(cena)) {
+        std::clog << "--simd ignorado: só cobre luzes pontuais sem --ambiente\n";
+        simd = false;
+    }
+    simd_isa isa = simd_parse(opcoes.get("--simd", "auto"));
+    std::vector<batch_light> luzes_lote = luzes_do_lote(cena);
+
+    auto inicio = std::chrono::steady_clock::now();
+    if (simd) {
+        std::clog << "sombreamento em lote: " << simd_name(simd_supported(isa) ? isa : simd_isa::scalar) << '\n';
+        render_tile_batches_streaming(pool, fb, tile_size, saida, [&](const tile& t) {
+            static thread_local hit_batch lote;
+            static thread_local batch_colors cores;
+            coletar_lote(cam, cena, t, lote);
+            shade_batch(lote, luzes_lote, cena.ambient, isa, cores);
+
+            for (int l = t.y0; l < t.y1; ++l)
+                for (int c = t.x0; c < t.x1; ++c)
+                    fb.at(c, l) = cena.background;
+            for (int i = 0; i < lote.size(); ++i)
+                fb.pixels[lote.pixel[i]] = cores.at(i);
+        });
+        std::clog << "\rConcluído.                  \n";
+        return 0;
+    }
+
+    std::uint64_t raios = render_tiles_streaming(pool, fb, tile_size, saida, [&](int c, int l) {
+        if (integrador) {
+            return integrate_pixel(c, l, amostrador.samples_per_pixel(), icfg, caminhos,
+                [&](int cc, int ll, double su, double sv) { return cam.get_ray(cc, ll, su, sv); },
+                [&](const ray& r, hit_record& rec) {
+                    rays_traced()++;
+                    return cena.world->hit(r, 0.001, std::numeric_limits<double>::infinity(), rec);
+                },
+                [&](const ray& r, const hit_record& rec) { return shade_hit(r, rec, cena); });
+        }
+        if (amostrador.samples_per_pixel() == 1)
+            return fixa ? ray_color_fixa<cena_fixa>(cam.get_ray(c, l)) : ray_color(cam.get_ray(c, l), cena);
+        return sample_pixel(c, l, amostrador, amostra);
+    });
 
     std::clog << "\rConcluído.                  \n";
-}
\ No newline at end of file
+    if (integrador) {
+        std::clog << "comprimento médio dos caminhos: " << caminhos.mean_length()
+                  << ", raios por pixel: " << double(raios) / fb.pixels.size()
+                  << " (" << elapsed_ms(inicio) << " ms)\n";
+    }
+} catch (const std::invalid_argument& e) {
+    // valor inválido em uma opção numérica (args::get_int, get_double)
+    std::cerr << e.what() << '\n';
+    return 1;
+} catch (const std::runtime_error& e) {
+    // opção fora da faixa aceita (--tile, --objetos, ...)
+    std::cerr << e.what() << '\n';
+    return 1;
+}
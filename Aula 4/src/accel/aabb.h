@@ -0,0 +1,129 @@
+#ifndef AABB_H
+#define AABB_H
+
+#include "../ray/ray.h"
+#include "../vectors/vec3.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+/**
+ * caixa alinhada aos eixos (axis-aligned bounding box)
+ * usada pelas estruturas de aceleração para descartar
+ * grupos inteiros de objetos com um único teste
+ */
+class aabb {
+  public:
+    point3 pmin;
+    point3 pmax;
+
+    // caixa vazia: qualquer união com ela devolve a outra caixa
+    aabb() {
+        const double inf = std::numeric_limits<double>::infinity();
+        pmin = point3(inf, inf, inf);
+        pmax = point3(-inf, -inf, -inf);
+    }
+
+    // aceita os dois cantos em qualquer ordem
+    aabb(const point3& a, const point3& b) {
+        pmin = point3(std::fmin(a.x(), b.x()), std::fmin(a.y(), b.y()), std::fmin(a.z(), b.z()));
+        pmax = point3(std::fmax(a.x(), b.x()), std::fmax(a.y(), b.y()), std::fmax(a.z(), b.z()));
+    }
+
+    // união de duas caixas
+    aabb(const aabb& a, const aabb& b) : aabb(a) {
+        expand(b);
+    }
+
+    // caixa de objetos ilimitados (planos)
+    static aabb universe() {
+        const double inf = std::numeric_limits<double>::infinity();
+        return aabb(point3(-inf, -inf, -inf), point3(inf, inf, inf));
+    }
+
+    bool is_empty() const {
+        return pmin.x() > pmax.x() || pmin.y() > pmax.y() || pmin.z() > pmax.z();
+    }
+
+    bool is_finite() const {
+        for (int i = 0; i < 3; ++i)
+            if (!std::isfinite(pmin[i]) || !std::isfinite(pmax[i])) return false;
+        return true;
+    }
+
+    void expand(const point3& p) {
+        for (int i = 0; i < 3; ++i) {
+            pmin[i] = std::fmin(pmin[i], p[i]);
+            pmax[i] = std::fmax(pmax[i], p[i]);
+        }
+    }
+
+    void expand(const aabb& b) {
+        for (int i = 0; i < 3; ++i) {
+            pmin[i] = std::fmin(pmin[i], b.pmin[i]);
+            pmax[i] = std::fmax(pmax[i], b.pmax[i]);
+        }
+    }
+
+    // caixa aumentada de 'd' em todas as direções
+    aabb padded(double d) const {
+        vec3 e(d, d, d);
+        return aabb(pmin - e, pmax + e);
+    }
+
+    point3 centroid() const {
+        return 0.5 * (pmin + pmax);
+    }
+
+    // eixo de maior extensão (0 = x, 1 = y, 2 = z)
+    int longest_axis() const {
+        vec3 e = pmax - pmin;
+        if (e.x() > e.y()) return e.x() > e.z() ? 0 : 2;
+        return e.y() > e.z() ? 1 : 2;
+    }
+
+    // área de superfície, usada pela heurística SAH
+    double surface_area() const {
+        if (is_empty()) return 0.0;
+        vec3 e = pmax - pmin;
+        return 2.0 * (e.x()*e.y() + e.y()*e.z() + e.z()*e.x());
+    }
+
+    // teste das placas (slab test)
+    // recebe 1/d já calculado para evitar três divisões por nó visitado
+    // em caso de acerto, t_entrada é a distância de entrada na caixa
+    bool hit(const point3& orig, const vec3& inv_dir, double ray_tmin, double ray_tmax, double& t_entrada) const {
+        for (int i = 0; i < 3; ++i) {
+            double t0 = (pmin[i] - orig[i]) * inv_dir[i];
+            double t1 = (pmax[i] - orig[i]) * inv_dir[i];
+            if (inv_dir[i] < 0.0) std::swap(t0, t1);
+
+            // NaN (0 * inf) não deve descartar a caixa
+            if (t0 > ray_tmin) ray_tmin = t0;
+            if (t1 < ray_tmax) ray_tmax = t1;
+            if (ray_tmax < ray_tmin) return false;
+        }
+        t_entrada = ray_tmin;
+        return true;
+    }
+
+    bool hit(const ray& r, double ray_tmin, double ray_tmax) const {
+        const vec3& d = r.direction();
+        vec3 inv_dir(1.0 / d.x(), 1.0 / d.y(), 1.0 / d.z());
+        double t;
+        return hit(r.origin(), inv_dir, ray_tmin, ray_tmax, t);
+    }
+};
+
+// caixa de um disco de centro c, normal unitária u e raio r
+// a extensão no eixo i é r * sqrt(1 - u_i²)
+inline aabb disc_box(const point3& c, const vec3& u, double r) {
+    vec3 e(
+        r * std::sqrt(std::fmax(0.0, 1.0 - u.x()*u.x())),
+        r * std::sqrt(std::fmax(0.0, 1.0 - u.y()*u.y())),
+        r * std::sqrt(std::fmax(0.0, 1.0 - u.z()*u.z()))
+    );
+    return aabb(c - e, c + e);
+}
+
+#endif
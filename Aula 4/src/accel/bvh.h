@@ -0,0 +1,331 @@
+#ifndef BVH_H
+#define BVH_H
+
+#include "aabb.h"
+#include "../objects/hittable.h"
+#include "../objects/hittable_list.h"
+
+#include <algorithm>
+#include <limits>
+#include <memory>
+#include <vector>
+
+/**
+ * hierarquia de volumes envolventes (BVH) em um vetor plano
+ *
+ * os nós ficam em pré-ordem: o filho esquerdo de um nó interno
+ * é sempre o nó seguinte e o direito está em 'right'. assim todo
+ * filho tem índice maior que o pai.
+ *
+ * objetos ilimitados (planos) não entram na árvore e são testados
+ * à parte, em O(k).
+ *
+ * como um bvh também é um hittable, ele pode ser o objeto de uma
+ * 'instance': um bvh de instâncias sobre bvhs de geometria compartilhada
+ * forma a estrutura de dois níveis.
+ *
+ * para cenas animadas: altere os objetos (sphere::set_center,
+ * cilindro::set_base, instance::set_transform...) e chame update(),
+ * que reajusta as caixas de baixo para cima em O(n) e só reconstrói
+ * a árvore quando o custo SAH piora demais em relação ao da construção.
+ * nada disso pode acontecer durante uma renderização.
+ */
+class bvh : public hittable {
+  public:
+    bvh() {}
+    explicit bvh(const hittable_list& list) : bvh(list.objects) {}
+    explicit bvh(const std::vector<shared_ptr<hittable>>& objects) { build(objects); }
+
+    // constrói a árvore com SAH por bins
+    // O(n log n)
+    void build(const std::vector<shared_ptr<hittable>>& objects) {
+        nodes.clear();
+        prims.clear();
+        unbounded.clear();
+
+        std::vector<shared_ptr<hittable>> bounded;
+        std::vector<aabb> boxes;
+        for (const auto& object : objects) {
+            aabb box = object->bounding_box();
+            if (box.is_finite()) {
+                bounded.push_back(object);
+                boxes.push_back(box);
+            } else {
+                unbounded.push_back(object);
+            }
+        }
+
+        std::vector<point3> centroids(boxes.size());
+        for (size_t i = 0; i < boxes.size(); ++i) centroids[i] = boxes[i].centroid();
+
+        std::vector<int> ordem(bounded.size());
+        for (size_t i = 0; i < ordem.size(); ++i) ordem[i] = int(i);
+
+        if (!bounded.empty()) {
+            nodes.reserve(2 * bounded.size());
+            build_node(ordem, boxes, centroids, 0, int(bounded.size()));
+        }
+
+        prims.reserve(bounded.size());
+        for (int i : ordem) prims.push_back(bounded[i]);
+
+        build_cost = sah_cost();
+    }
+
+    // recalcula as caixas de todos os nós, de baixo para cima
+    // como os filhos têm índice maior que o pai, basta percorrer
+    // o vetor de trás para frente
+    // O(n)
+    void refit() {
+        for (int i = int(nodes.size()) - 1; i >= 0; --i) {
+            node& n = nodes[i];
+            aabb box;
+            if (n.count > 0) {
+                for (int p = n.first; p < n.first + n.count; ++p)
+                    box.expand(prims[p]->bounding_box());
+            } else {
+                box = aabb(nodes[i + 1].box, nodes[n.right].box);
+            }
+            n.box = box;
+        }
+    }
+
+    // reajusta e, se a qualidade caiu além de 'limiar' vezes o custo
+    // da construção, reconstrói. devolve true se reconstruiu.
+    bool update(double limiar = 1.5) {
+        refit();
+        if (sah_cost() <= limiar * build_cost) return false;
+
+        build(objects());
+        return true;
+    }
+
+    // custo SAH normalizado pela área da raiz:
+    // soma de A(nó) por nó interno + A(folha) * primitivas por folha
+    // (custos de travessia e interseção iguais a 1)
+    double sah_cost() const {
+        if (nodes.empty()) return 0.0;
+        double area_raiz = nodes[0].box.surface_area();
+        if (area_raiz <= 0) return 0.0;
+
+        double custo = 0.0;
+        for (const auto& n : nodes)
+            custo += n.box.surface_area() * (n.count > 0 ? n.count : 1);
+        return custo / area_raiz;
+    }
+
+    bool hit(const ray& r, double ray_tmin, double ray_tmax, hit_record& rec) const override {
+        hit_record temp_rec;
+        bool hit_anything = false;
+        double closest_so_far = ray_tmax;
+
+        for (const auto& object : unbounded) {
+            if (object->hit(r, ray_tmin, closest_so_far, temp_rec)) {
+                hit_anything = true;
+                closest_so_far = temp_rec.t;
+                rec = temp_rec;
+            }
+        }
+
+        if (nodes.empty()) return hit_anything;
+
+        const vec3& d = r.direction();
+        vec3 inv_dir(1.0 / d.x(), 1.0 / d.y(), 1.0 / d.z());
+        bool dir_neg[3] = { inv_dir.x() < 0, inv_dir.y() < 0, inv_dir.z() < 0 };
+
+        int stack[max_depth];
+        int sp = 0;
+        stack[sp++] = 0;
+
+        while (sp > 0) {
+            const node& n = nodes[stack[--sp]];
+            double t_entrada;
+            if (!n.box.hit(r.origin(), inv_dir, ray_tmin, closest_so_far, t_entrada))
+                continue;
+
+            if (n.count > 0) {
+                for (int i = n.first; i < n.first + n.count; ++i) {
+                    if (prims[i]->hit(r, ray_tmin, closest_so_far, temp_rec)) {
+                        hit_anything = true;
+                        closest_so_far = temp_rec.t;
+                        rec = temp_rec;
+                    }
+                }
+                continue;
+            }
+
+            // empilha primeiro o filho mais distante ao longo do eixo de divisão
+            int left = int(&n - nodes.data()) + 1;
+            if (dir_neg[n.axis]) {
+                stack[sp++] = left;
+                stack[sp++] = n.right;
+            } else {
+                stack[sp++] = n.right;
+                stack[sp++] = left;
+            }
+        }
+
+        return hit_anything;
+    }
+
+    // igual a hit(), mas para na primeira interseção encontrada
+    // (só objetos com casts_shadows)
+    bool hit_any(const ray& r, double ray_tmin, double ray_tmax) const override {
+        for (const auto& object : unbounded)
+            if (object->casts_shadows && object->hit_any(r, ray_tmin, ray_tmax)) return true;
+
+        if (nodes.empty()) return false;
+
+        const vec3& d = r.direction();
+        vec3 inv_dir(1.0 / d.x(), 1.0 / d.y(), 1.0 / d.z());
+
+        int stack[max_depth];
+        int sp = 0;
+        stack[sp++] = 0;
+
+        while (sp > 0) {
+            int idx = stack[--sp];
+            const node& n = nodes[idx];
+            double t_entrada;
+            if (!n.box.hit(r.origin(), inv_dir, ray_tmin, ray_tmax, t_entrada))
+                continue;
+
+            if (n.count > 0) {
+                for (int i = n.first; i < n.first + n.count; ++i)
+                    if (prims[i]->casts_shadows && prims[i]->hit_any(r, ray_tmin, ray_tmax))
+                        return true;
+                continue;
+            }
+
+            stack[sp++] = n.right;
+            stack[sp++] = idx + 1;
+        }
+
+        return false;
+    }
+
+    aabb bounding_box() const override {
+        if (!unbounded.empty()) return aabb::universe();
+        return nodes.empty() ? aabb() : nodes[0].box;
+    }
+
+    // todos os objetos, limitados e ilimitados
+    std::vector<shared_ptr<hittable>> objects() const {
+        std::vector<shared_ptr<hittable>> todos(prims);
+        todos.insert(todos.end(), unbounded.begin(), unbounded.end());
+        return todos;
+    }
+
+    size_t node_count() const { return nodes.size(); }
+    size_t primitive_count() const { return prims.size() + unbounded.size(); }
+
+  private:
+    struct node {
+        aabb box;
+        // índice do filho direito (nós internos)
+        int right = 0;
+        // intervalo de primitivas em 'prims' (folhas: count > 0)
+        int first = 0;
+        int count = 0;
+        // eixo de divisão (nós internos)
+        int axis = 0;
+    };
+
+    static constexpr int max_depth = 128;
+    static constexpr int max_leaf = 4;
+    static constexpr int n_bins = 12;
+
+    std::vector<node> nodes;
+    std::vector<shared_ptr<hittable>> prims;
+    std::vector<shared_ptr<hittable>> unbounded;
+    double build_cost = 0.0;
+
+    int build_node(std::vector<int>& ordem, const std::vector<aabb>& boxes,
+                   const std::vector<point3>& centroids, int first, int count, int depth = 0) {
+        int idx = int(nodes.size());
+        nodes.emplace_back();
+
+        aabb box, cbox;
+        for (int i = first; i < first + count; ++i) {
+            box.expand(boxes[ordem[i]]);
+            cbox.expand(centroids[ordem[i]]);
+        }
+        nodes[idx].box = box;
+
+        auto make_leaf = [&]() {
+            nodes[idx].first = first;
+            nodes[idx].count = count;
+            return idx;
+        };
+
+        if (count <= 2) return make_leaf();
+
+        int axis = cbox.longest_axis();
+        double lo = cbox.pmin[axis];
+        double extent = cbox.pmax[axis] - lo;
+        int mid = first + count / 2;
+
+        if (extent > 0) {
+            // SAH por bins: custo(divisão) = A_esq * N_esq + A_dir * N_dir
+            aabb bin_box[n_bins];
+            int bin_count[n_bins] = {};
+            double escala = n_bins / extent;
+            auto bin_of = [&](int prim) {
+                int b = int((centroids[prim][axis] - lo) * escala);
+                return std::min(b, n_bins - 1);
+            };
+
+            for (int i = first; i < first + count; ++i) {
+                int b = bin_of(ordem[i]);
+                bin_count[b]++;
+                bin_box[b].expand(boxes[ordem[i]]);
+            }
+
+            double custo_dir[n_bins];
+            aabb acc;
+            int acc_n = 0;
+            for (int b = n_bins - 1; b > 0; --b) {
+                acc.expand(bin_box[b]);
+                acc_n += bin_count[b];
+                custo_dir[b] = acc_n * acc.surface_area();
+            }
+
+            double melhor = std::numeric_limits<double>::infinity();
+            int melhor_bin = -1;
+            acc = aabb();
+            acc_n = 0;
+            for (int b = 0; b < n_bins - 1; ++b) {
+                acc.expand(bin_box[b]);
+                acc_n += bin_count[b];
+                double custo = acc_n * acc.surface_area() + custo_dir[b + 1];
+                if (custo < melhor) {
+                    melhor = custo;
+                    melhor_bin = b;
+                }
+            }
+
+            // vale mais uma folha do que dividir?
+            double custo_folha = count * box.surface_area();
+            if (count <= max_leaf && melhor >= custo_folha) return make_leaf();
+
+            auto it = std::partition(ordem.begin() + first, ordem.begin() + first + count,
+                [&](int prim) { return bin_of(prim) <= melhor_bin; });
+            mid = int(it - ordem.begin());
+        }
+
+        // centróides coincidentes ou partição degenerada: divide pela mediana
+        if (mid == first || mid == first + count || depth >= max_depth - 2) {
+            if (depth >= max_depth - 2) return make_leaf();
+            mid = first + count / 2;
+            std::nth_element(ordem.begin() + first, ordem.begin() + mid, ordem.begin() + first + count,
+                [&](int a, int b) { return centroids[a][axis] < centroids[b][axis]; });
+        }
+
+        nodes[idx].axis = axis;
+        build_node(ordem, boxes, centroids, first, mid - first, depth + 1);
+        nodes[idx].right = build_node(ordem, boxes, centroids, mid, first + count - mid, depth + 1);
+        return idx;
+    }
+};
+
+#endif
@@ -0,0 +1,196 @@
+#ifndef BENCHMARK_H
+#define BENCHMARK_H
+
+#include "../accel/bvh.h"
+#include "../render/camera.h"
+#include "../render/framebuffer.h"
+#include "../render/renderer.h"
+#include "../render/shade_batch.h"
+#include "../render/thread_pool.h"
+#include "../sampling/sampler.h"
+#include "../scene/gerador.h"
+#include "../scene/scene.h"
+
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#ifdef __linux__
+#include <unistd.h>
+#endif
+
+// memória residente do processo em MB (0 se a plataforma não informar)
+inline double resident_memory_mb() {
+#ifdef __linux__
+    std::ifstream statm("/proc/self/statm");
+    long total = 0, residente = 0;
+    if (statm >> total >> residente)
+        return residente * double(sysconf(_SC_PAGESIZE)) / (1024.0 * 1024.0);
+#endif
+    return 0.0;
+}
+
+inline double elapsed_ms(std::chrono::steady_clock::time_point inicio) {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - inicio).count();
+}
+
+struct bench_config {
+    std::vector<std::size_t> ns = {10, 100, 1000, 10000, 100000, 1000000};
+    std::vector<int> threads;
+    std::uint64_t seed = 42;
+    int resolution = 256;
+    int tile_size = 16;
+};
+
+/**
+ * curva de escala: para cada n, gera o cenário procedural, constrói o bvh
+ * e renderiza com cada quantidade de threads.
+ * imprime uma tabela (tsv) com tempos, raios/s e memória.
+ *
+ * trace(r, cena) é a função de cor do main() (ray_color)
+ */
+template <class Trace>
+void run_scaling_bench(const bench_config& cfg, const Trace& trace, std::ostream& out) {
+    std::vector<int> threads = cfg.threads;
+    if (threads.empty()) {
+        for (int t = 1; t < thread_pool::default_size(); t *= 2) threads.push_back(t);
+        threads.push_back(thread_pool::default_size());
+    }
+
+    out << "n\tthreads\tgerar_ms\tbvh_ms\trender_ms\traios\traios_por_s\tmemoria_rss_mb\n";
+
+    for (std::size_t n : cfg.ns) {
+        auto t0 = std::chrono::steady_clock::now();
+        scene cena = gerar_cena(n, cfg.seed);
+        double gerar_ms = elapsed_ms(t0);
+
+        camera cam;
+        cam.nCol = cam.nLin = cfg.resolution;
+
+        t0 = std::chrono::steady_clock::now();
+        cena.build(cam.zoio);
+        double bvh_ms = elapsed_ms(t0);
+        cena.objects.clear();
+
+        // memória residente total com o cenário construído
+        double memoria = resident_memory_mb();
+
+        for (int t : threads) {
+            thread_pool pool(t);
+            framebuffer fb(cam.nCol, cam.nLin);
+
+            t0 = std::chrono::steady_clock::now();
+            std::uint64_t raios = render_tiles(pool, fb, cfg.tile_size, [&](int c, int l) {
+                return trace(cam.get_ray(c, l), cena);
+            });
+            double render_ms = elapsed_ms(t0);
+
+            out << n << '\t' << t << '\t'
+                << std::fixed << std::setprecision(1) << gerar_ms << '\t' << bvh_ms << '\t' << render_ms << '\t'
+                << raios << '\t' << std::setprecision(0) << raios / (render_ms / 1000.0) << '\t'
+                << std::setprecision(1) << memoria << '\n' << std::flush;
+            out.unsetf(std::ios::floatfield);
+        }
+    }
+}
+
+struct sampler_bench_config {
+    std::vector<int> spps = {1, 4, 16, 64};
+    int reference_spp = 1024;
+    int resolution = 128;
+    int tile_size = 16;
+};
+
+/**
+ * compara os amostradores com o mesmo número de amostras por pixel:
+ * renderiza uma referência com muitas amostras independentes (outra
+ * semente) e mede o erro rms de cada amostrador contra ela.
+ *
+ * shade(cam, c, l, su, sv) devolve uma amostra do pixel
+ */
+template <class Shade>
+void run_sampler_bench(const sampler_bench_config& cfg, thread_pool& pool, const Shade& shade,
+                       std::ostream& out) {
+    camera cam;
+    cam.nCol = cam.nLin = cfg.resolution;
+    auto amostra = [&](int c, int l, double su, double sv) { return shade(cam, c, l, su, sv); };
+
+    auto t0 = std::chrono::steady_clock::now();
+    framebuffer ref(cam.nCol, cam.nLin);
+    sampler s_ref(sampler::kind::independent, cfg.reference_spp, 0x7e7e7e7e);
+    render_tiles(pool, ref, cfg.tile_size, [&](int c, int l) { return sample_pixel(c, l, s_ref, amostra); });
+    out << "referencia: " << cfg.reference_spp << " spp, " << std::fixed << std::setprecision(1)
+        << elapsed_ms(t0) << " ms\n";
+    out.unsetf(std::ios::floatfield);
+
+    out << "amostrador\tspp\trmse\trender_ms\n";
+    for (int spp : cfg.spps) {
+        for (auto k : {sampler::kind::independent, sampler::kind::stratified,
+                       sampler::kind::sobol, sampler::kind::blue_noise}) {
+            sampler s(k, spp);
+            framebuffer fb(cam.nCol, cam.nLin);
+            t0 = std::chrono::steady_clock::now();
+            render_tiles(pool, fb, cfg.tile_size, [&](int c, int l) { return sample_pixel(c, l, s, amostra); });
+            double ms = elapsed_ms(t0);
+
+            double soma = 0.0;
+            for (size_t i = 0; i < fb.pixels.size(); ++i) {
+                vec3 d = fb.pixels[i] - ref.pixels[i];
+                soma += dot(d, d) / 3.0;
+            }
+            out << sampler::name(k) << '\t' << spp << '\t' << std::setprecision(6)
+                << std::sqrt(soma / fb.pixels.size()) << '\t' << std::fixed << std::setprecision(1)
+                << ms << '\n' << std::flush;
+            out.unsetf(std::ios::floatfield);
+            out << std::setprecision(6);
+        }
+    }
+}
+
+// tempo do sombreamento em lote (sem traçado) de cada conjunto de
+// instruções contra a referência em double; o erro é o maior desvio
+// de um canal, em níveis de 8 bits
+inline void run_shading_bench(const hit_batch& lote, const std::vector<batch_light>& luzes,
+                              const color& ambiente, int repeticoes, std::ostream& out) {
+    auto mede = [&](auto&& f) {
+        double melhor = 1e300;
+        for (int r = 0; r < repeticoes; ++r) {
+            auto t0 = std::chrono::steady_clock::now();
+            f();
+            melhor = std::min(melhor, elapsed_ms(t0));
+        }
+        return melhor;
+    };
+
+    batch_colors ref;
+    double ref_ms = mede([&] { shade_batch_reference(lote, luzes, ambiente, ref); });
+
+    out << lote.size() << " pontos, " << luzes.size() << " luzes\n";
+    out << "caminho\tns_por_ponto\tganho\terro_max\n";
+    out << std::fixed << std::setprecision(2);
+    out << "referencia\t" << 1e6 * ref_ms / lote.size() << "\t1.00\t0.00\n";
+    for (auto isa : {simd_isa::scalar, simd_isa::avx2, simd_isa::avx512}) {
+        if (!simd_supported(isa)) {
+            out << simd_name(isa) << "\tsem suporte\n";
+            continue;
+        }
+        batch_colors cor;
+        double ms = mede([&] { shade_batch(lote, luzes, ambiente, isa, cor); });
+        double erro = 0.0;
+        for (int i = 0; i < lote.size(); ++i) {
+            erro = std::max(erro, double(std::fabs(cor.r[i] - ref.r[i])));
+            erro = std::max(erro, double(std::fabs(cor.g[i] - ref.g[i])));
+            erro = std::max(erro, double(std::fabs(cor.b[i] - ref.b[i])));
+        }
+        out << simd_name(isa) << '\t' << 1e6 * ms / lote.size() << '\t' << ref_ms / ms << '\t'
+            << std::setprecision(3) << 255.999 * erro << std::setprecision(2) << '\n';
+    }
+    out.unsetf(std::ios::floatfield);
+}
+
+#endif
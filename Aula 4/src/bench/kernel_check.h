@@ -0,0 +1,523 @@
+#ifndef KERNEL_CHECK_H
+#define KERNEL_CHECK_H
+
+#include "benchmark.h"
+#include "../accel/bvh.h"
+#include "../objects/cilindro.h"
+#include "../objects/cone.h"
+#include "../objects/instance.h"
+#include "../objects/plano.h"
+#include "../objects/sphere.h"
+#include "../scene/baked.h"
+#include "../util/fast_math.h"
+#include "../util/rng.h"
+#include "../vectors/transform.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <functional>
+#include <iomanip>
+#include <limits>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <vector>
+
+/**
+ * validação diferencial dos núcleos de interseção
+ *
+ * para cada forma, a implementação de referência é o hit() da classe
+ * (double). cada variante (cenário assado, instância em espaço local,
+ * bvh, raio de sombra, e as versões float/SIMD que vierem) recebe os
+ * mesmos raios e é comparada com ela:
+ *   - acerto/erro divergente;
+ *   - t com erro relativo acima de t_tol;
+ *   - normal com |n - n_ref| acima de n_tol.
+ *
+ * os raios vêm em cinco categorias:
+ *   - aleatorio: origem e alvo sorteados em volta do objeto;
+ *   - rasante: tangentes à superfície (com desvio de ~1e-7);
+ *   - eixo: direções paralelas a x, y, z e ao eixo do objeto;
+ *   - interior: origem dentro do objeto (ou colada no plano);
+ *   - borda: mirando as bordas das tampas e o vértice do cone.
+ * um quarto dos raios tem tmax finito, para testar o intervalo.
+ *
+ * uma variante passa se não divergir em nenhum raio, fora das
+ * categorias marcadas em loose: nelas o problema é mal condicionado
+ * para a variante (raios rasantes numa instância, cujo raio passa pela
+ * inversa) e as divergências só são informadas.
+ */
+
+struct kernel_hit {
+    double t;
+    vec3 normal;
+};
+
+using kernel_fn = std::function<bool(const ray&, double, double, kernel_hit&)>;
+
+struct kernel_variant {
+    std::string name;
+    kernel_fn hit;
+    // só compara acerto/erro (raios de sombra)
+    bool only_hit = false;
+    double t_tol = 1e-9;
+    double n_tol = 1e-9;
+    // bits (1 << categoria) em que divergir não é falha
+    unsigned loose = 0;
+};
+
+enum class ray_kind { aleatorio, rasante, eixo, interior, borda };
+inline constexpr int ray_kinds = 5;
+
+inline const char* ray_kind_name(int k) {
+    static const char* nomes[] = {"aleatorio", "rasante", "eixo", "interior", "borda"};
+    return nomes[k];
+}
+
+struct kernel_shape {
+    std::string name;
+    kernel_fn reference;
+    std::vector<kernel_variant> variants;
+    // esfera envolvente (para sortear origens)
+    point3 center;
+    double size;
+    // direções especiais além de x, y e z
+    std::vector<vec3> axes;
+    // ponto e normal na superfície
+    std::function<void(rng&, point3&, vec3&)> surface;
+    std::function<point3(rng&)> interior;
+    std::function<point3(rng&)> edge;
+};
+
+struct kernel_ray {
+    ray r;
+    double tmin, tmax;
+    int kind;
+};
+
+inline vec3 kc_in_ball(rng& g) {
+    for (;;) {
+        vec3 p(g.uniform(-1, 1), g.uniform(-1, 1), g.uniform(-1, 1));
+        if (p.length_squared() <= 1.0) return p;
+    }
+}
+
+inline vec3 kc_unit(rng& g) {
+    for (;;) {
+        vec3 p = kc_in_ball(g);
+        double l2 = p.length_squared();
+        if (l2 > 1e-6) return p / std::sqrt(l2);
+    }
+}
+
+// base ortonormal (e1, e2) perpendicular a u (unitário)
+inline void kc_basis(const vec3& u, vec3& e1, vec3& e2) {
+    vec3 a = std::fabs(u.x()) < 0.9 ? vec3(1, 0, 0) : vec3(0, 1, 0);
+    e1 = unit_vector(cross(u, a));
+    e2 = cross(u, e1);
+}
+
+inline std::vector<kernel_ray> make_kernel_rays(const kernel_shape& s, std::size_t por_categoria,
+                                                std::uint64_t seed) {
+    const double inf = std::numeric_limits<double>::infinity();
+    std::vector<kernel_ray> raios;
+    raios.reserve(por_categoria * ray_kinds);
+    std::vector<vec3> eixos = {vec3(1, 0, 0), vec3(0, 1, 0), vec3(0, 0, 1)};
+    eixos.insert(eixos.end(), s.axes.begin(), s.axes.end());
+
+    for (int k = 0; k < ray_kinds; ++k) {
+        rng g(seed ^ (std::uint64_t(k + 1) * 0x9e3779b97f4a7c15ull));
+        for (std::size_t i = 0; i < por_categoria; ++i) {
+            point3 o;
+            vec3 d;
+            switch (ray_kind(k)) {
+            case ray_kind::aleatorio: {
+                o = s.center + 3 * s.size * kc_in_ball(g);
+                d = (s.center + s.size * kc_in_ball(g)) - o;
+                break;
+            }
+            case ray_kind::rasante: {
+                point3 p;
+                vec3 n;
+                s.surface(g, p, n);
+                d = unit_vector(cross(n, kc_unit(g))) + g.uniform(-1e-7, 1e-7) * n;
+                o = p - g.uniform(0.1, 2.0) * s.size * d;
+                break;
+            }
+            case ray_kind::eixo: {
+                d = eixos[g.next() % eixos.size()];
+                if (g.next() & 1) d = -d;
+                o = s.center + s.size * kc_in_ball(g) - g.uniform(1.0, 3.0) * s.size * d;
+                break;
+            }
+            case ray_kind::interior: {
+                o = s.interior(g);
+                d = kc_unit(g);
+                break;
+            }
+            case ray_kind::borda: {
+                point3 alvo = s.edge(g) + 1e-7 * s.size * kc_in_ball(g);
+                o = s.center + g.uniform(1.5, 3.0) * s.size * kc_unit(g);
+                d = alvo - o;
+                break;
+            }
+            }
+            // direções não unitárias também (a != 1 nas equações)
+            d *= g.uniform(0.5, 2.0);
+            double tmax = (g.next() & 3) == 0 ? g.uniform(0.0, 4.0 * s.size) : inf;
+            raios.push_back({ray(o, d), 0.001, tmax, k});
+        }
+    }
+    return raios;
+}
+
+struct kernel_report {
+    std::string shape, variant;
+    std::size_t rays = 0;
+    std::size_t hit_miss[ray_kinds] = {};
+    std::size_t t_bad[ray_kinds] = {};
+    std::size_t n_bad[ray_kinds] = {};
+    // raios divergentes (um raio pode errar t e normal)
+    std::size_t bad_rays[ray_kinds] = {};
+    unsigned loose = 0;
+    double max_t_error = 0.0;
+    double max_n_error = 0.0;
+    double ns_per_ray = 0.0;
+    double speed = 0.0;  // relativa à referência (> 1 é mais rápida)
+    bool ok = true;
+    // primeiro raio divergente, para reproduzir
+    bool has_example = false;
+    kernel_ray example;
+
+    std::size_t mismatches() const {
+        std::size_t total = 0;
+        for (int k = 0; k < ray_kinds; ++k) total += hit_miss[k] + t_bad[k] + n_bad[k];
+        return total;
+    }
+};
+
+// melhor de 'repeats' passadas, em ns por raio
+inline double time_kernel(const kernel_fn& f, const std::vector<kernel_ray>& raios, int repeats) {
+    double melhor = 1e300;
+    volatile std::size_t sink = 0;
+    for (int i = 0; i < std::max(1, repeats); ++i) {
+        auto t0 = std::chrono::steady_clock::now();
+        std::size_t acertos = 0;
+        kernel_hit h;
+        for (const auto& kr : raios) acertos += f(kr.r, kr.tmin, kr.tmax, h);
+        melhor = std::min(melhor, elapsed_ms(t0));
+        sink = sink + acertos;
+    }
+    return melhor * 1e6 / std::max<std::size_t>(1, raios.size());
+}
+
+inline std::vector<kernel_report> check_kernels(const kernel_shape& s, std::size_t por_categoria,
+                                                std::uint64_t seed, int repeats) {
+    auto raios = make_kernel_rays(s, por_categoria, seed);
+
+    // resultados da referência, calculados uma vez
+    std::vector<char> ref_acerto(raios.size());
+    std::vector<kernel_hit> ref(raios.size());
+    for (std::size_t i = 0; i < raios.size(); ++i)
+        ref_acerto[i] = s.reference(raios[i].r, raios[i].tmin, raios[i].tmax, ref[i]);
+    double ns_ref = time_kernel(s.reference, raios, repeats);
+
+    std::vector<kernel_report> out;
+    kernel_report base;
+    base.shape = s.name;
+    base.variant = "referencia";
+    base.rays = raios.size();
+    base.ns_per_ray = ns_ref;
+    base.speed = 1.0;
+    out.push_back(base);
+
+    for (const auto& v : s.variants) {
+        kernel_report rep;
+        rep.shape = s.name;
+        rep.variant = v.name;
+        rep.rays = raios.size();
+
+        for (std::size_t i = 0; i < raios.size(); ++i) {
+            const auto& kr = raios[i];
+            kernel_hit h;
+            bool acertou = v.hit(kr.r, kr.tmin, kr.tmax, h);
+            bool divergiu = false;
+            if (acertou != bool(ref_acerto[i])) {
+                ++rep.hit_miss[kr.kind];
+                divergiu = true;
+            } else if (acertou && !v.only_hit) {
+                double et = std::fabs(h.t - ref[i].t) / std::max(std::fabs(ref[i].t), 1e-300);
+                double en = (h.normal - ref[i].normal).length();
+                if (!(et <= v.t_tol)) { ++rep.t_bad[kr.kind]; divergiu = true; }
+                if (!(en <= v.n_tol)) { ++rep.n_bad[kr.kind]; divergiu = true; }
+                // NaN conta como infinito
+                rep.max_t_error = std::max(rep.max_t_error, et == et ? et : HUGE_VAL);
+                rep.max_n_error = std::max(rep.max_n_error, en == en ? en : HUGE_VAL);
+            }
+            if (!divergiu) continue;
+            ++rep.bad_rays[kr.kind];
+            if (!rep.has_example || ((v.loose >> rep.example.kind) & 1)) {
+                // prefere um exemplo que conta como falha
+                rep.has_example = true;
+                rep.example = kr;
+            }
+        }
+
+        rep.ns_per_ray = time_kernel(v.hit, raios, repeats);
+        rep.speed = ns_ref / rep.ns_per_ray;
+        rep.loose = v.loose;
+        for (int k = 0; k < ray_kinds; ++k)
+            if (!((v.loose >> k) & 1) && rep.bad_rays[k] > 0) rep.ok = false;
+        out.push_back(rep);
+    }
+    return out;
+}
+
+// tabela (tsv) com uma linha por forma e variante, as divergências por
+// categoria e um raio de exemplo para cada variante que divergiu
+inline bool print_kernel_reports(const std::vector<kernel_report>& reps, std::ostream& out) {
+    bool ok = true;
+    out << "forma\tvariante\traios\tacerto_erro\tt\tnormal\terro_t_max\terro_n_max\tns_raio\tx_ref\tresultado\n";
+    for (const auto& r : reps) {
+        std::size_t hm = 0, tb = 0, nb = 0;
+        for (int k = 0; k < ray_kinds; ++k) {
+            hm += r.hit_miss[k];
+            tb += r.t_bad[k];
+            nb += r.n_bad[k];
+        }
+        out << r.shape << '\t' << r.variant << '\t' << r.rays << '\t' << hm << '\t' << tb << '\t' << nb
+            << '\t' << std::setprecision(3) << r.max_t_error << '\t' << r.max_n_error << '\t'
+            << std::fixed << std::setprecision(1) << r.ns_per_ray << '\t' << std::setprecision(2)
+            << r.speed << '\t' << (r.ok ? "ok" : "FALHOU") << '\n';
+        out.unsetf(std::ios::floatfield);
+        ok = ok && r.ok;
+    }
+
+    bool cabecalho = false;
+    for (const auto& r : reps) {
+        if (r.mismatches() == 0) continue;
+        if (!cabecalho) {
+            out << "\ndivergências por categoria (acerto_erro/t/normal, * = só informada):\n";
+            cabecalho = true;
+        }
+        out << r.shape << ' ' << r.variant << ':';
+        for (int k = 0; k < ray_kinds; ++k)
+            if (r.hit_miss[k] + r.t_bad[k] + r.n_bad[k] > 0)
+                out << ' ' << ray_kind_name(k) << (((r.loose >> k) & 1) ? "*" : "") << '=' << r.hit_miss[k] << '/' << r.t_bad[k] << '/'
+                    << r.n_bad[k];
+        const auto& e = r.example;
+        out << "\n  exemplo (" << ray_kind_name(e.kind) << "): origem " << std::setprecision(17)
+            << e.r.origin() << " direção " << e.r.direction() << " tmin " << e.tmin << " tmax "
+            << e.tmax << '\n';
+        out << std::setprecision(6);
+    }
+    if (!ok) out << "*** núcleos divergentes: ver as linhas FALHOU acima ***\n";
+    return ok;
+}
+
+/**
+ * as formas testadas, todas posicionadas com a mesma transformação
+ * (rotação, escala 2 e translação) a partir de um objeto no espaço
+ * local; o objeto local envolto em uma instância é a variante
+ * "instancia", e fica com o mesmo objeto no mundo
+ */
+inline std::vector<kernel_shape> kernel_shapes() {
+    const transform xf = transform::translate(vec3(3, -1, -20))
+                       * transform::rotate(vec3(1, 2, 3), 0.7)
+                       * transform::scale(2, 2, 2);
+    const double escala = 2.0;
+    const double pi = 3.1415926535897932385;
+    auto mat = std::make_shared<material>(color(0.5, 0.5, 0.5), color(0.5, 0.5, 0.5), color(0, 0, 0), 1);
+
+    auto de_classe = [](std::shared_ptr<hittable> obj) -> kernel_fn {
+        return [obj](const ray& r, double tmin, double tmax, kernel_hit& h) {
+            hit_record rec;
+            if (!obj->hit(r, tmin, tmax, rec)) return false;
+            h.t = rec.t;
+            h.normal = rec.normal;
+            return true;
+        };
+    };
+    auto de_sombra = [](std::shared_ptr<hittable> obj) -> kernel_fn {
+        return [obj](const ray& r, double tmin, double tmax, kernel_hit&) {
+            return obj->hit_any(r, tmin, tmax);
+        };
+    };
+    auto de_assado = [](auto obj) -> kernel_fn {
+        return [obj](const ray& r, double tmin, double tmax, kernel_hit& h) {
+            baked_hit rec;
+            if (!obj.hit(r, tmin, tmax, rec)) return false;
+            h.t = rec.t;
+            h.normal = rec.normal;
+            return true;
+        };
+    };
+
+    // variantes comuns: assado, bvh e sombra fazem as mesmas contas da
+    // classe, então a tolerância é zero; na instância o raio passa pela
+    // inversa, t e normal mudam nos últimos bits e raios rasantes ou
+    // nas bordas podem trocar de acerto para erro ou de raiz
+    auto variantes = [&](kernel_fn assado, std::shared_ptr<hittable> obj, std::shared_ptr<hittable> local) {
+        std::vector<kernel_variant> v;
+        v.push_back({"assado", assado, false, 0.0, 0.0});
+        v.push_back({"instancia", de_classe(std::make_shared<instance>(local, xf)), false, 1e-9, 1e-9,
+                     (1u << int(ray_kind::rasante)) | (1u << int(ray_kind::borda))});
+        v.push_back({"bvh", de_classe(std::make_shared<bvh>(std::vector<std::shared_ptr<hittable>>{obj})), false, 0.0, 0.0});
+        v.push_back({"sombra", de_sombra(obj), true});
+        return v;
+    };
+
+    std::vector<kernel_shape> formas;
+
+    {
+        const double raio_local = 5.0;
+        point3 c = xf.point(point3(0, 0, 0));
+        double raio = raio_local * escala;
+        auto obj = std::make_shared<sphere>(c, raio, mat);
+        kernel_shape s;
+        s.name = "esfera";
+        s.reference = de_classe(obj);
+        s.variants = variantes(de_assado(baked_sphere{c, raio, 0}), obj,
+                               std::make_shared<sphere>(point3(0, 0, 0), raio_local, mat));
+        s.center = c;
+        s.size = raio;
+        s.surface = [=](rng& g, point3& p, vec3& n) { n = kc_unit(g); p = c + raio * n; };
+        s.interior = [=](rng& g) { return c + 0.999 * raio * kc_in_ball(g); };
+        // na esfera, a borda é a silhueta: qualquer ponto da superfície
+        s.edge = [=](rng& g) { return c + raio * kc_unit(g); };
+        formas.push_back(s);
+    }
+
+    {
+        const double h_local = 6.0, raio_local = 2.0;
+        point3 base = xf.point(point3(0, 0, 0));
+        vec3 u = unit_vector(xf.vector(vec3(0, 1, 0)));
+        double h = h_local * escala, raio = raio_local * escala;
+        point3 topo = base + u * h;
+        vec3 e1, e2;
+        kc_basis(u, e1, e2);
+        auto obj = std::make_shared<cilindro>(base, u, h, raio, true, true, mat);
+        kernel_shape s;
+        s.name = "cilindro";
+        s.reference = de_classe(obj);
+        s.variants = variantes(de_assado(baked_cylinder::make(base, u, h, raio, true, true, 0)), obj,
+                               std::make_shared<cilindro>(point3(0, 0, 0), vec3(0, 1, 0), h_local,
+                                                          raio_local, true, true, mat));
+        s.center = base + u * (h / 2);
+        s.size = std::sqrt(h * h / 4 + raio * raio);
+        s.axes = {u};
+        s.surface = [=](rng& g, point3& p, vec3& n) {
+            double a = g.uniform(0, 2 * pi);
+            vec3 radial = std::cos(a) * e1 + std::sin(a) * e2;
+            // corpo ou tampas, pela área
+            double corpo = 2 * pi * raio * h, tampas = 2 * pi * raio * raio;
+            if (g.uniform() * (corpo + tampas) < corpo) {
+                p = base + g.uniform(0, h) * u + raio * radial;
+                n = radial;
+            } else {
+                bool em_cima = g.next() & 1;
+                p = (em_cima ? topo : base) + std::sqrt(g.uniform()) * raio * radial;
+                n = em_cima ? u : -u;
+            }
+        };
+        s.interior = [=](rng& g) {
+            double a = g.uniform(0, 2 * pi);
+            return base + g.uniform(0, h) * u
+                 + 0.999 * std::sqrt(g.uniform()) * raio * (std::cos(a) * e1 + std::sin(a) * e2);
+        };
+        s.edge = [=](rng& g) {
+            double a = g.uniform(0, 2 * pi);
+            return ((g.next() & 1) ? topo : base) + raio * (std::cos(a) * e1 + std::sin(a) * e2);
+        };
+        formas.push_back(s);
+    }
+
+    {
+        const double h_local = 8.0, raio_local = 3.0;
+        point3 base = xf.point(point3(0, 0, 0));
+        vec3 u = unit_vector(xf.vector(vec3(0, 1, 0)));
+        double h = h_local * escala, raio = raio_local * escala;
+        point3 vertice = base + u * h;
+        vec3 e1, e2;
+        kc_basis(u, e1, e2);
+        auto obj = std::make_shared<cone>(base, u, h, raio, true, mat);
+        kernel_shape s;
+        s.name = "cone";
+        s.reference = de_classe(obj);
+        s.variants = variantes(de_assado(baked_cone::make(base, u, h, raio, true, 0)), obj,
+                               std::make_shared<cone>(point3(0, 0, 0), vec3(0, 1, 0), h_local,
+                                                      raio_local, true, mat));
+        s.center = base + u * (h / 2);
+        s.size = std::sqrt(h * h / 4 + raio * raio);
+        s.axes = {u};
+        s.surface = [=](rng& g, point3& p, vec3& n) {
+            double a = g.uniform(0, 2 * pi);
+            vec3 radial = std::cos(a) * e1 + std::sin(a) * e2;
+            if (g.next() & 1) {
+                double y = g.uniform(0, h);
+                p = base + y * u + raio * (1 - y / h) * radial;
+                n = unit_vector(h * radial + raio * u);
+            } else {
+                p = base + std::sqrt(g.uniform()) * raio * radial;
+                n = -u;
+            }
+        };
+        s.interior = [=](rng& g) {
+            double a = g.uniform(0, 2 * pi);
+            double y = g.uniform(0, h);
+            return base + y * u
+                 + 0.999 * std::sqrt(g.uniform()) * raio * (1 - y / h) * (std::cos(a) * e1 + std::sin(a) * e2);
+        };
+        // borda da base ou o vértice
+        s.edge = [=](rng& g) {
+            if ((g.next() & 3) == 0) return vertice;
+            double a = g.uniform(0, 2 * pi);
+            return base + raio * (std::cos(a) * e1 + std::sin(a) * e2);
+        };
+        formas.push_back(s);
+    }
+
+    {
+        point3 p0 = xf.point(point3(0, 0, 0));
+        vec3 n = unit_vector(xf.normal(vec3(0, 1, 0)));
+        vec3 e1, e2;
+        kc_basis(n, e1, e2);
+        const double tamanho = 20.0;
+        auto obj = std::make_shared<plane>(p0, n, mat);
+        kernel_shape s;
+        s.name = "plano";
+        s.reference = de_classe(obj);
+        s.variants = variantes(de_assado(baked_plane::make(p0, n, 0)), obj,
+                               std::make_shared<plane>(point3(0, 0, 0), vec3(0, 1, 0), mat));
+        s.center = p0;
+        s.size = tamanho;
+        s.axes = {n};
+        auto no_plano = [=](rng& g) {
+            vec3 q = kc_in_ball(g);
+            return p0 + tamanho * (q.x() * e1 + q.y() * e2);
+        };
+        s.surface = [=](rng& g, point3& p, vec3& nn) { p = no_plano(g); nn = n; };
+        // o plano não tem interior: origens coladas nele, na escala do tmin
+        s.interior = [=](rng& g) { return no_plano(g) + g.uniform(-2e-3, 2e-3) * n; };
+        s.edge = no_plano;
+        formas.push_back(s);
+    }
+
+    return formas;
+}
+
+// roda todas as formas; falso se alguma variante falhou
+inline bool run_kernel_check(std::size_t por_categoria, std::uint64_t seed, int repeats, std::ostream& out) {
+    out << "# " << por_categoria << " raios por categoria e forma, semente " << seed
+        << (fast_math ? ", build FAST_MATH" : "") << '\n';
+    std::vector<kernel_report> todos;
+    for (const auto& s : kernel_shapes()) {
+        auto reps = check_kernels(s, por_categoria, seed, repeats);
+        todos.insert(todos.end(), reps.begin(), reps.end());
+    }
+    return print_kernel_reports(todos, out);
+}
+
+#endif
@@ -0,0 +1,196 @@
+#ifndef REGRESSION_H
+#define REGRESSION_H
+
+#include "benchmark.h"
+#include "../render/framebuffer.h"
+#include "../render/image_compare.h"
+#include "../util/arquivo.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <map>
+#include <ostream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+/**
+ * regressão de imagem e de desempenho
+ *
+ * cada caso renderiza um cenário de referência. com record, a imagem
+ * vira a de ouro (dir/<nome>.ppm) e o tempo vira a base
+ * (dir/desempenho.tsv). sem record, a imagem é comparada com a de ouro
+ * (PSNR mínimo e erro máximo por canal) e o tempo com a base: ficar
+ * mais lento que slowdown_max vezes a base também é falha.
+ *
+ * cada amostra de tempo repete o caso até somar min_sample_ms e divide
+ * pelo número de renderizações (os casos levam de 0.1 a poucos ms, e
+ * uma renderização só é ruído). as amostras são tiradas em rodadas,
+ * uma de cada caso por rodada, para que uma fase lenta da máquina
+ * (vizinhos na mesma vm, frequência) não caia toda em um caso só; o
+ * tempo do caso é a menor das 'repeats' amostras, o estimador menos
+ * sensível a esse ruído, que só soma. só é lentidão se passar de
+ * slowdown_max vezes a base e também de slack_ms acima dela.
+ *
+ * mesmo assim, numa vm o mesmo caso alterna entre fases de ~1 s com
+ * tempos até 1.8x diferentes. um caso que parece lento é medido de novo
+ * até 'confirm' vezes, com uma pausa antes, e só falha se continuar
+ * lento em todas. a base só vale na mesma máquina e com o mesmo número
+ * de threads.
+ */
+struct regression_case {
+    std::string name;
+    // renderiza em fb (já do tamanho certo); devolve os raios disparados
+    std::function<std::uint64_t(framebuffer&)> render;
+    int width = 128;
+    int height = 128;
+};
+
+struct regression_config {
+    std::string dir = "regressao";
+    bool record = false;
+    double psnr_min = 45.0;
+    int max_error = 8;
+    double slowdown_max = 1.25;
+    double slack_ms = 0.5;
+    double min_sample_ms = 50.0;
+    int repeats = 5;
+    int confirm = 3;
+};
+
+// ms por chamada de f, repetindo até somar min_ms
+template <class F>
+double regression_sample(double min_ms, const F& f) {
+    auto t0 = std::chrono::steady_clock::now();
+    int n = 0;
+    double ms;
+    do {
+        f();
+        ++n;
+        ms = elapsed_ms(t0);
+    } while (ms < min_ms);
+    return ms / n;
+}
+
+// devolve falso se algum caso falhou (ou se faltar imagem de ouro)
+inline bool run_regression(const regression_config& cfg, const std::vector<regression_case>& casos,
+                           std::ostream& out) {
+    namespace fs = std::filesystem;
+    fs::create_directories(cfg.dir);
+    std::string base_path = cfg.dir + "/desempenho.tsv";
+
+    // base de desempenho: nome -> ms
+    std::map<std::string, double> base;
+    {
+        std::ifstream in(base_path);
+        std::string linha;
+        while (std::getline(in, linha)) {
+            std::istringstream ss(linha);
+            std::string nome;
+            double ms;
+            if (ss >> nome >> ms) base[nome] = ms;
+        }
+    }
+
+    bool ok = true;
+    std::ostringstream nova_base;
+    out << "caso\tpsnr_db\terro_max\tms\tms_base\traios_por_s\tresultado\n";
+
+    // tempos, em rodadas
+    std::vector<framebuffer> imagens;
+    std::vector<double> tempos(casos.size(), 1e300);
+    std::vector<std::uint64_t> raios(casos.size(), 0);
+    for (const auto& caso : casos) imagens.emplace_back(caso.width, caso.height);
+    for (int r = 0; r < std::max(1, cfg.repeats); ++r)
+        for (std::size_t i = 0; i < casos.size(); ++i)
+            tempos[i] = std::min(tempos[i], regression_sample(cfg.min_sample_ms, [&] {
+                raios[i] = casos[i].render(imagens[i]);
+            }));
+
+    for (std::size_t i = 0; i < casos.size(); ++i) {
+        const auto& caso = casos[i];
+        const framebuffer& fb = imagens[i];
+        double ms = tempos[i];
+        double raios_por_s = raios[i] / (ms / 1000.0);
+        nova_base << caso.name << '\t' << ms << '\t' << (long long)raios_por_s << '\n';
+
+        std::ostringstream ppm;
+        fb.write_ppm(ppm);
+        std::string ouro = cfg.dir + "/" + caso.name + ".ppm";
+
+        out << caso.name << '\t';
+        if (cfg.record) {
+            write_file_atomic(ouro, [&](std::ostream& o) { o << ppm.str(); });
+            out << "-\t-\t" << std::fixed << std::setprecision(2) << ms << "\t-\t"
+                << (long long)raios_por_s << "\tgravado\n";
+            out.unsetf(std::ios::floatfield);
+            continue;
+        }
+
+        std::vector<std::string> falhas;
+        ppm_image atual, esperado;
+        std::istringstream atual_in(ppm.str());
+        std::ifstream esperado_in(ouro);
+        read_ppm(atual_in, atual);
+        image_diff d;
+        if (!read_ppm(esperado_in, esperado)) {
+            falhas.push_back("sem imagem de ouro");
+        } else {
+            d = compare_images(esperado, atual);
+            if (!d.same_size) falhas.push_back("tamanho diferente");
+            else if (d.psnr < cfg.psnr_min) falhas.push_back("psnr abaixo de " + std::to_string(cfg.psnr_min));
+            else if (d.max_error > cfg.max_error) falhas.push_back("erro acima de " + std::to_string(cfg.max_error));
+        }
+
+        auto b = base.find(caso.name);
+        auto lento = [&] {
+            return b != base.end() && ms > cfg.slowdown_max * b->second && ms > b->second + cfg.slack_ms;
+        };
+        framebuffer rascunho(caso.width, caso.height);
+        for (int k = 0; k < cfg.confirm && lento(); ++k) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(500));
+            for (int r = 0; r < std::max(1, cfg.repeats); ++r)
+                ms = std::min(ms, regression_sample(cfg.min_sample_ms, [&] { caso.render(rascunho); }));
+        }
+        raios_por_s = raios[i] / (ms / 1000.0);
+        if (lento()) {
+            std::ostringstream msg;
+            msg << std::setprecision(2) << ms / b->second << "x mais lento";
+            falhas.push_back(msg.str());
+        }
+
+        // sem comparação válida, psnr inf pareceria imagem idêntica
+        if (!d.same_size) out << (falhas.front() == "sem imagem de ouro" ? "sem ouro" : "tamanho diferente") << "\t-\t";
+        else out << std::setprecision(4) << d.psnr << '\t' << d.max_error << '\t';
+        out << std::fixed
+            << std::setprecision(2) << ms << '\t';
+        if (b != base.end()) out << b->second;
+        else out << '-';
+        out << '\t' << (long long)raios_por_s << '\t';
+        out.unsetf(std::ios::floatfield);
+        out << std::setprecision(6);
+
+        if (falhas.empty()) {
+            out << "ok\n";
+        } else {
+            ok = false;
+            out << "FALHOU:";
+            for (const auto& f : falhas) out << ' ' << f << ';';
+            out << '\n';
+        }
+    }
+
+    if (cfg.record)
+        write_file_atomic(base_path, [&](std::ostream& o) { o << nova_base.str(); });
+    else if (!ok)
+        out << "*** REGRESSÃO: ver as linhas FALHOU acima ***\n";
+    return ok;
+}
+
+#endif
@@ -0,0 +1,393 @@
+#ifndef FARM_H
+#define FARM_H
+
+#include "../render/framebuffer.h"
+#include "../render/render_stats.h"
+#include "../render/renderer.h"
+#include "../render/thread_pool.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <deque>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <poll.h>
+#include <signal.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+/**
+ * fazenda de renderização local: um coordenador divide o quadro em
+ * tiles e distribui entre processos trabalhadores
+ *
+ * cada trabalhador é o próprio executável com --worker, que carrega o
+ * mesmo cenário e conversa pelo stdin/stdout. o protocolo é de linhas
+ * de texto, com os pixels em binário logo depois da linha DONE:
+ *
+ *   trabalhador -> coordenador  HELLO <pid>
+ *   coordenador -> trabalhador  TILE <id> <x0> <y0> <x1> <y1> <spp>
+ *   trabalhador -> coordenador  DONE <id> <n_pixels> <raios>
+ *                               + n_pixels * 3 doubles (rgb, linha a linha)
+ *   coordenador -> trabalhador  QUIT
+ *
+ * trocar os pipes por sockets basta para levar os trabalhadores para
+ * outras máquinas; o protocolo não muda.
+ */
+
+// laço do trabalhador: lê pedidos no stdin até QUIT ou EOF
+// shade(c, l, su, sv) devolve uma amostra do pixel; com amostrador, as
+// posições no pixel vêm dele em vez do jitter de sample_pixel
+template <class Shade>
+int farm_worker_main(thread_pool& pool, const Shade& shade, const sampler* amostrador = nullptr) {
+#ifdef _WIN32
+    std::cerr << "--worker não é suportado no windows\n";
+    return 1;
+#else
+    std::cout << "HELLO " << getpid() << '\n' << std::flush;
+
+    std::string linha;
+    std::vector<double> pixels;
+    while (std::getline(std::cin, linha)) {
+        std::istringstream ss(linha);
+        std::string cmd;
+        ss >> cmd;
+        if (cmd == "QUIT") break;
+        if (cmd != "TILE") continue;
+
+        int id = -1, x0 = 0, y0 = 0, x1 = 0, y1 = 0, spp = 0;
+        if (!(ss >> id >> x0 >> y0 >> x1 >> y1 >> spp) || id < 0 || x0 < 0 || y0 < 0 ||
+            x1 <= x0 || y1 <= y0 || spp < 1) {
+            std::cerr << "pedido inválido: " << linha << '\n';
+            continue;
+        }
+        int w = x1 - x0;
+        pixels.assign(size_t(w) * (y1 - y0) * 3, 0.0);
+
+        std::atomic<std::uint64_t> raios{0};
+        pool.parallel_for(y1 - y0, [&](int i) {
+            std::uint64_t antes = rays_traced();
+            for (int c = x0; c < x1; ++c) {
+                color p = amostrador ? sample_pixel(c, y0 + i, *amostrador, shade)
+                                     : sample_pixel(c, y0 + i, spp, shade);
+                size_t k = (size_t(i) * w + (c - x0)) * 3;
+                pixels[k] = p.x(); pixels[k + 1] = p.y(); pixels[k + 2] = p.z();
+            }
+            raios += rays_traced() - antes;
+        });
+
+        std::cout << "DONE " << id << ' ' << pixels.size() / 3 << ' ' << raios << '\n';
+        std::cout.write(reinterpret_cast<const char*>(pixels.data()),
+                        std::streamsize(pixels.size() * sizeof(double)));
+        std::cout.flush();
+    }
+    return 0;
+#endif
+}
+
+struct farm_config {
+    int workers = 2;
+    int tile_size = 32;
+    int spp = 1;
+    // caminho do executável e argumentos extras (cenário, threads)
+    std::string exe;
+    std::vector<std::string> worker_args;
+    // um tile é "lento" depois de fator * tempo médio por tile
+    double slow_factor = 4.0;
+    std::chrono::milliseconds min_slow{1000};
+};
+
+/**
+ * coordenador: distribui os tiles, junta os resultados em fb
+ * e imprime a vazão de cada trabalhador em 'relatorio'
+ *
+ * tiles de um trabalhador que morreu voltam para a fila. quando a
+ * fila esvazia, tiles parados há tempo demais em um trabalhador lento
+ * são repetidos em um trabalhador livre; vale o primeiro resultado.
+ */
+inline bool farm_render(const farm_config& cfg, framebuffer& fb, std::ostream& relatorio) {
+#ifdef _WIN32
+    relatorio << "--farm não é suportado no windows\n";
+    return false;
+#else
+    using clock = std::chrono::steady_clock;
+
+    struct worker {
+        pid_t pid = -1;
+        int to = -1, from = -1;
+        std::string buf;
+        bool alive = false, ready = false;
+        int tile = -1;
+        clock::time_point inicio;
+        int tiles = 0;
+        long long pixels = 0;
+        std::uint64_t raios = 0;
+        double ocupado_ms = 0.0;
+    };
+
+    if (cfg.workers < 1) {
+        relatorio << "a fazenda precisa de pelo menos um trabalhador\n";
+        return false;
+    }
+
+    // escrever em um pipe de trabalhador morto não pode matar o coordenador
+    signal(SIGPIPE, SIG_IGN);
+
+    auto tiles = make_tiles(fb.width, fb.height, cfg.tile_size);
+    std::vector<worker> ws(cfg.workers);
+
+    // o argv dos filhos fica pronto antes do fork: entre o fork e o execv
+    // o filho de um processo com threads só pode chamar funções seguras
+    // para sinais, e alocar memória não é uma delas
+    std::vector<std::string> args_filho = {cfg.exe, "--worker"};
+    args_filho.insert(args_filho.end(), cfg.worker_args.begin(), cfg.worker_args.end());
+    std::vector<char*> argv_filho;
+    for (auto& s : args_filho) argv_filho.push_back(&s[0]);
+    argv_filho.push_back(nullptr);
+
+    // sem pipe ou sem fork, o trabalhador fica morto (sem fds abertos);
+    // a fazenda segue com os que subiram
+    for (auto& w : ws) {
+        int para_filho[2], do_filho[2];
+        if (pipe(para_filho) != 0) continue;
+        if (pipe(do_filho) != 0) {
+            close(para_filho[0]); close(para_filho[1]);
+            continue;
+        }
+
+        // as pontas do coordenador não vazam para os próximos filhos
+        fcntl(para_filho[1], F_SETFD, FD_CLOEXEC);
+        fcntl(do_filho[0], F_SETFD, FD_CLOEXEC);
+
+        pid_t pid = fork();
+        if (pid == 0) {
+            dup2(para_filho[0], 0);
+            dup2(do_filho[1], 1);
+            close(para_filho[0]); close(para_filho[1]);
+            close(do_filho[0]); close(do_filho[1]);
+            execv(argv_filho[0], argv_filho.data());
+            _exit(127);
+        }
+
+        close(para_filho[0]);
+        close(do_filho[1]);
+        if (pid < 0) {
+            close(para_filho[1]);
+            close(do_filho[0]);
+            continue;
+        }
+        w.pid = pid;
+        w.to = para_filho[1];
+        w.from = do_filho[0];
+        w.alive = true;
+    }
+
+    auto envia = [](worker& w, const std::string& msg) {
+        const char* p = msg.data();
+        size_t n = msg.size();
+        while (n > 0) {
+            ssize_t k = write(w.to, p, n);
+            if (k <= 0) return false;
+            p += k;
+            n -= size_t(k);
+        }
+        return true;
+    };
+
+    std::deque<int> fila;
+    for (int i = 0; i < int(tiles.size()); ++i) fila.push_back(i);
+    std::vector<char> feito(tiles.size(), 0);
+    std::vector<int> copias(tiles.size(), 0);
+    int restantes = int(tiles.size());
+    double soma_ms = 0.0;
+    int medidos = 0;
+
+    auto morre = [&](worker& w) {
+        if (!w.alive) return;
+        w.alive = false;
+        close(w.to);
+        close(w.from);
+        waitpid(w.pid, nullptr, 0);
+        // o tile só volta para a fila se nenhuma outra cópia dele
+        // continua rodando em um trabalhador vivo
+        if (w.tile >= 0) {
+            copias[w.tile]--;
+            if (!feito[w.tile] && copias[w.tile] == 0) fila.push_front(w.tile);
+        }
+        w.tile = -1;
+        relatorio << "trabalhador " << w.pid << " morreu\n";
+    };
+
+    auto atribui = [&](worker& w, int t) {
+        const tile& tl = tiles[t];
+        std::ostringstream msg;
+        msg << "TILE " << t << ' ' << tl.x0 << ' ' << tl.y0 << ' ' << tl.x1 << ' ' << tl.y1
+            << ' ' << cfg.spp << '\n';
+        w.tile = t;
+        w.inicio = clock::now();
+        copias[t]++;
+        if (!envia(w, msg.str())) morre(w);
+    };
+
+    // processa as mensagens completas no buffer do trabalhador
+    auto consome = [&](worker& w) {
+        for (;;) {
+            size_t fim = w.buf.find('\n');
+            if (fim == std::string::npos) return;
+
+            std::istringstream ss(w.buf.substr(0, fim));
+            std::string cmd;
+            ss >> cmd;
+            if (cmd == "HELLO") {
+                w.ready = true;
+                w.buf.erase(0, fim + 1);
+                continue;
+            }
+            if (cmd != "DONE") {
+                w.buf.erase(0, fim + 1);
+                continue;
+            }
+
+            // só vale a resposta do tile que este trabalhador recebeu, com o
+            // número de pixels dele; qualquer outra coisa é um trabalhador
+            // com defeito, e o tile volta para a fila
+            int id = -1;
+            long long n = -1;
+            std::uint64_t raios = 0;
+            if (!(ss >> id >> n >> raios) || id < 0 || id >= int(tiles.size()) || id != w.tile ||
+                n != (long long)(tiles[id].x1 - tiles[id].x0) * (tiles[id].y1 - tiles[id].y0)) {
+                relatorio << "resposta inválida do trabalhador " << w.pid << '\n';
+                morre(w);
+                return;
+            }
+            size_t bytes = size_t(n) * 3 * sizeof(double);
+            if (w.buf.size() < fim + 1 + bytes) return;
+
+            std::vector<double> px(size_t(n) * 3);
+            std::memcpy(px.data(), w.buf.data() + fim + 1, bytes);
+            double ms = std::chrono::duration<double, std::milli>(clock::now() - w.inicio).count();
+            copias[id]--;
+            if (!feito[id]) {
+                const tile& t = tiles[id];
+                size_t k = 0;
+                for (int l = t.y0; l < t.y1; ++l)
+                    for (int c = t.x0; c < t.x1; ++c, k += 3)
+                        fb.at(c, l) = color(px[k], px[k + 1], px[k + 2]);
+                feito[id] = 1;
+                restantes--;
+                soma_ms += ms;
+                medidos++;
+            }
+            w.tiles++;
+            w.pixels += n;
+            w.raios += raios;
+            w.ocupado_ms += ms;
+            w.tile = -1;
+            w.buf.erase(0, fim + 1 + bytes);
+        }
+    };
+
+    auto inicio = clock::now();
+    char bloco[1 << 16];
+
+    while (restantes > 0) {
+        bool algum_vivo = false;
+        for (auto& w : ws) algum_vivo = algum_vivo || w.alive;
+        if (!algum_vivo) {
+            relatorio << "todos os trabalhadores morreram\n";
+            return false;
+        }
+
+        // trabalho novo para quem está livre
+        for (auto& w : ws) {
+            if (!w.alive || !w.ready || w.tile >= 0) continue;
+            while (!fila.empty() && feito[fila.front()]) fila.pop_front();
+            if (!fila.empty()) {
+                int t = fila.front();
+                fila.pop_front();
+                atribui(w, t);
+                continue;
+            }
+
+            // fila vazia: repete um tile parado em um trabalhador lento
+            double media = medidos > 0 ? soma_ms / medidos : 0.0;
+            double limite = std::max(double(cfg.min_slow.count()), cfg.slow_factor * media);
+            for (auto& outro : ws) {
+                if (&outro == &w || !outro.alive || outro.tile < 0) continue;
+                if (copias[outro.tile] > 1) continue;
+                double parado = std::chrono::duration<double, std::milli>(clock::now() - outro.inicio).count();
+                if (parado > limite) {
+                    relatorio << "tile " << outro.tile << " repetido (trabalhador " << outro.pid << " lento)\n";
+                    atribui(w, outro.tile);
+                    break;
+                }
+            }
+        }
+
+        std::vector<pollfd> fds;
+        std::vector<worker*> donos;
+        for (auto& w : ws) {
+            if (!w.alive) continue;
+            fds.push_back({w.from, POLLIN, 0});
+            donos.push_back(&w);
+        }
+        if (poll(fds.data(), fds.size(), 100) < 0) continue;
+
+        for (size_t i = 0; i < fds.size(); ++i) {
+            if (!(fds[i].revents & (POLLIN | POLLHUP | POLLERR))) continue;
+            worker& w = *donos[i];
+            ssize_t k = read(w.from, bloco, sizeof(bloco));
+            if (k <= 0) {
+                morre(w);
+                continue;
+            }
+            w.buf.append(bloco, size_t(k));
+            consome(w);
+        }
+    }
+
+    double total_ms = std::chrono::duration<double, std::milli>(clock::now() - inicio).count();
+
+    // trabalhadores livres saem com QUIT; os que ainda estão em um tile
+    // repetido (ou travados) recebem SIGKILL depois de um tempo
+    for (auto& w : ws) {
+        if (!w.alive) continue;
+        envia(w, "QUIT\n");
+        close(w.to);
+        close(w.from);
+    }
+    auto prazo = clock::now() + std::chrono::seconds(2);
+    for (auto& w : ws) {
+        if (!w.alive) continue;
+        if (w.tile >= 0) kill(w.pid, SIGKILL);
+        while (waitpid(w.pid, nullptr, WNOHANG) == 0) {
+            if (clock::now() > prazo) {
+                kill(w.pid, SIGKILL);
+                waitpid(w.pid, nullptr, 0);
+                break;
+            }
+            usleep(10000);
+        }
+    }
+
+    relatorio << "trabalhador\ttiles\tpixels\traios\traios_por_s\n";
+    for (const auto& w : ws) {
+        double seg = w.ocupado_ms / 1000.0;
+        relatorio << w.pid << '\t' << w.tiles << '\t' << w.pixels << '\t' << w.raios << '\t'
+                  << (long long)(seg > 0 ? w.raios / seg : 0.0) << '\n';
+    }
+    relatorio << "total: " << (long long)total_ms << " ms\n";
+    return true;
+#endif
+}
+
+#endif
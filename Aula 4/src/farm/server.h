@@ -0,0 +1,434 @@
+#ifndef SERVER_H
+#define SERVER_H
+
+#include "../render/framebuffer.h"
+#include "../scene/scene.h"
+#include "../util/args.h"
+#include "../util/lru_cache.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#ifndef _WIN32
+#include <signal.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+/**
+ * serviço de renderização local: um processo de vida longa recebe
+ * pedidos pelo stdin ou por um socket unix e devolve as imagens,
+ * sem reconstruir o cenário a cada imagem
+ *
+ * o protocolo é de linhas de texto, como o da fazenda, com a imagem
+ * (ppm P3) em bytes logo depois da linha IMAGE:
+ *
+ *   cliente -> servidor  RENDER <id> <opções>
+ *                        opções no formato da linha de comando, p.ex.
+ *                        --cena gerada --objetos 500 --res 256 --spp 4
+ *                        --olho x,y,z põe o olho em (x, y, z) olhando
+ *                        para o centro do cenário, (0, 0, -100)
+ *   servidor -> cliente  IMAGE <id> <bytes> <ms_fila> <ms_render> <hit|miss>
+ *                        + <bytes> bytes do ppm; ms_render inclui montar
+ *                        o cenário quando ele não estava no cache (miss)
+ *   servidor -> cliente  ERROR <id> <mensagem>
+ *   cliente -> servidor  STATS
+ *   servidor -> cliente  STATS <chave=valor ...>
+ *   cliente -> servidor  QUIT (fecha a conexão)
+ *   cliente -> servidor  SHUTDOWN (termina a fila e encerra o servidor)
+ *
+ * os pedidos entram em uma fila única e são atendidos um por vez, cada
+ * um com todas as threads do pool. os cenários prontos (com bvh e
+ * oclusores) ficam em um cache LRU indexado pela chave do cenário.
+ * pelo stdin, o fim da entrada também encerra o servidor.
+ */
+
+// o que o servidor precisa saber do main()
+struct server_handlers {
+    // chave das opções que mudam o cenário (não a câmera nem o spp)
+    std::function<std::string(const args&)> scene_key;
+    // cenário pronto para renderizar (já com build())
+    std::function<std::shared_ptr<const scene>(const args&)> build;
+    // renderiza o pedido; devolve os raios disparados
+    std::function<std::uint64_t(const args&, const scene&, framebuffer&)> render;
+};
+
+// latência (chegada -> resposta) dos últimos pedidos e profundidade da fila
+class server_metrics {
+  public:
+    void received(std::size_t fila) {
+        std::lock_guard<std::mutex> lock(mtx);
+        ++recebidos;
+        profundidade = fila;
+        profundidade_max = std::max(profundidade_max, fila);
+    }
+
+    void dequeued(std::size_t fila) {
+        std::lock_guard<std::mutex> lock(mtx);
+        profundidade = fila;
+    }
+
+    void finished(bool ok, double ms_fila, double ms_total, std::uint64_t raios) {
+        std::lock_guard<std::mutex> lock(mtx);
+        ++(ok ? feitos : falhos);
+        soma_fila_ms += ms_fila;
+        total_raios += raios;
+        if (latencias.size() < janela) latencias.push_back(ms_total);
+        else latencias[proxima] = ms_total;
+        proxima = (proxima + 1) % janela;
+    }
+
+    void canceled() {
+        std::lock_guard<std::mutex> lock(mtx);
+        ++cancelados;
+    }
+
+    void cache(bool hit, std::size_t entradas, std::size_t removidas) {
+        std::lock_guard<std::mutex> lock(mtx);
+        ++(hit ? acertos : faltas);
+        cenarios = entradas;
+        remocoes = removidas;
+    }
+
+    // uma linha "chave=valor ..."; latências nos últimos 'janela' pedidos
+    std::string line() const {
+        std::lock_guard<std::mutex> lock(mtx);
+        std::vector<double> l = latencias;
+        std::sort(l.begin(), l.end());
+        auto q = [&](double p) { return l.empty() ? 0.0 : l[std::size_t(p * (l.size() - 1) + 0.5)]; };
+        std::size_t atendidos = feitos + falhos;
+
+        std::ostringstream s;
+        s << std::fixed << std::setprecision(1) << "fila=" << profundidade << " fila_max="
+          << profundidade_max << " recebidos=" << recebidos << " feitos=" << feitos << " erros=" << falhos
+          << " cancelados=" << cancelados << " lat_p50_ms=" << q(0.5) << " lat_p95_ms=" << q(0.95)
+          << " lat_max_ms=" << (l.empty() ? 0.0 : l.back())
+          << " espera_media_ms=" << (atendidos ? soma_fila_ms / atendidos : 0.0)
+          << " cache_acertos=" << acertos << " cache_faltas=" << faltas << " cenarios=" << cenarios
+          << " removidos=" << remocoes << " raios=" << total_raios;
+        return s.str();
+    }
+
+  private:
+    static constexpr std::size_t janela = 1024;
+    mutable std::mutex mtx;
+    std::size_t recebidos = 0, feitos = 0, falhos = 0, cancelados = 0;
+    std::size_t profundidade = 0, profundidade_max = 0;
+    std::size_t acertos = 0, faltas = 0, cenarios = 0, remocoes = 0;
+    double soma_fila_ms = 0.0;
+    std::uint64_t total_raios = 0;
+    std::vector<double> latencias;
+    std::size_t proxima = 0;
+};
+
+#ifndef _WIN32
+
+// uma conexão (o par stdin/stdout ou um socket aceito)
+// as respostas podem vir da thread que lê e da que renderiza
+class server_connection {
+  public:
+    server_connection(int in, int out, bool owns) : in(in), out(out), owns(owns) {}
+
+    ~server_connection() {
+        if (owns) close(in);
+    }
+
+    // desbloqueia o read() de quem está lendo (só sockets)
+    void hang_up() {
+        if (owns) ::shutdown(in, SHUT_RDWR);
+    }
+
+    server_connection(const server_connection&) = delete;
+    server_connection& operator=(const server_connection&) = delete;
+
+    // próxima linha (sem o '\n'); falso no fim da entrada
+    bool read_line(std::string& linha) {
+        for (;;) {
+            size_t fim = buf.find('\n');
+            if (fim != std::string::npos) {
+                linha = buf.substr(0, fim);
+                buf.erase(0, fim + 1);
+                if (!linha.empty() && linha.back() == '\r') linha.pop_back();
+                return true;
+            }
+            char bloco[4096];
+            ssize_t k = read(in, bloco, sizeof(bloco));
+            if (k <= 0) return false;
+            buf.append(bloco, size_t(k));
+        }
+    }
+
+    bool send(const std::string& msg) {
+        std::lock_guard<std::mutex> lock(mtx);
+        const char* p = msg.data();
+        size_t n = msg.size();
+        while (n > 0) {
+            ssize_t k = write(out, p, n);
+            if (k <= 0) {
+                closed = true;
+                return false;
+            }
+            p += k;
+            n -= size_t(k);
+        }
+        return true;
+    }
+
+    // uma escrita falhou (o cliente saiu): os pedidos dele ainda na
+    // fila são descartados
+    std::atomic<bool> closed{false};
+
+  private:
+    int in, out;
+    bool owns;
+    std::string buf;
+    std::mutex mtx;
+};
+
+class render_server {
+  public:
+    render_server(server_handlers h, std::size_t cache_capacity)
+      : handlers(std::move(h)), cenarios(cache_capacity) {}
+
+    // atende pelo stdin/stdout até SHUTDOWN ou fim da entrada
+    int serve_stdio() {
+        signal(SIGPIPE, SIG_IGN);
+        auto conn = std::make_shared<server_connection>(0, 1, false);
+        std::thread leitor([this, conn] {
+            read_requests(conn);
+            stop();
+        });
+        run_jobs();
+        leitor.join();
+        std::clog << "servidor: " << metricas.line() << '\n';
+        return 0;
+    }
+
+    // atende em um socket unix até SHUTDOWN; uma thread leitora por cliente
+    int serve_unix(const std::string& caminho) {
+        signal(SIGPIPE, SIG_IGN);
+        int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+        sockaddr_un addr{};
+        addr.sun_family = AF_UNIX;
+        if (fd < 0 || caminho.size() >= sizeof(addr.sun_path)) {
+            std::clog << "servidor: caminho de socket inválido\n";
+            return 1;
+        }
+        std::copy(caminho.begin(), caminho.end(), addr.sun_path);
+        unlink(caminho.c_str());
+        if (bind(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0 || listen(fd, 16) != 0) {
+            std::clog << "servidor: não consegui escutar em " << caminho << '\n';
+            close(fd);
+            return 1;
+        }
+        std::clog << "servidor: escutando em " << caminho << '\n';
+
+        // no fim, shutdown() desbloqueia o accept e os read() dos clientes
+        std::thread aceitador([this, fd] {
+            for (;;) {
+                int c = accept(fd, nullptr, nullptr);
+                if (c < 0) return;
+                auto conn = std::make_shared<server_connection>(c, c, true);
+                {
+                    std::lock_guard<std::mutex> lock(conn_mtx);
+                    abertas.erase(std::remove_if(abertas.begin(), abertas.end(),
+                                                 [](const auto& w) { return w.expired(); }),
+                                  abertas.end());
+                    abertas.push_back(conn);
+                    ++leitores;
+                }
+                // o aviso sai só no fim da thread, para o servidor poder
+                // ser destruído logo depois da espera
+                std::thread([this, conn] {
+                    read_requests(conn);
+                    std::unique_lock<std::mutex> lock(conn_mtx);
+                    --leitores;
+                    std::notify_all_at_thread_exit(conn_cv, std::move(lock));
+                }).detach();
+            }
+        });
+        run_jobs();
+        ::shutdown(fd, SHUT_RDWR);
+        aceitador.join();
+        close(fd);
+        {
+            std::unique_lock<std::mutex> lock(conn_mtx);
+            for (auto& w : abertas)
+                if (auto c = w.lock()) c->hang_up();
+            conn_cv.wait(lock, [this] { return leitores == 0; });
+        }
+        unlink(caminho.c_str());
+        std::clog << "servidor: " << metricas.line() << '\n';
+        return 0;
+    }
+
+  private:
+    using clock = std::chrono::steady_clock;
+
+    struct job {
+        std::string id;
+        std::vector<std::string> opcoes;
+        std::shared_ptr<server_connection> conn;
+        clock::time_point chegada;
+    };
+
+    server_handlers handlers;
+    // só a thread que renderiza mexe no cache
+    lru_cache<std::string, std::shared_ptr<const scene>> cenarios;
+    server_metrics metricas;
+
+    std::deque<job> fila;
+    std::mutex mtx;
+    std::condition_variable cv;
+    bool parando = false;
+
+    // clientes do socket, para desconectar no fim
+    std::vector<std::weak_ptr<server_connection>> abertas;
+    int leitores = 0;
+    std::mutex conn_mtx;
+    std::condition_variable conn_cv;
+
+    void stop() {
+        {
+            std::lock_guard<std::mutex> lock(mtx);
+            parando = true;
+        }
+        cv.notify_all();
+    }
+
+    // lê os comandos de uma conexão; cada RENDER entra na fila assim que
+    // é lido. depois de QUIT ou do fim da entrada, as respostas pendentes
+    // ainda são enviadas (a conexão fecha com o último pedido)
+    void read_requests(const std::shared_ptr<server_connection>& conn) {
+        std::string linha;
+        while (conn->read_line(linha)) {
+            std::istringstream ss(linha);
+            std::string cmd;
+            ss >> cmd;
+            if (cmd == "QUIT") break;
+            if (cmd == "SHUTDOWN") {
+                stop();
+                break;
+            }
+            if (cmd == "STATS") {
+                conn->send("STATS " + metricas.line() + '\n');
+                continue;
+            }
+            if (cmd != "RENDER") {
+                if (!cmd.empty()) conn->send("ERROR - comando desconhecido: " + cmd + '\n');
+                continue;
+            }
+
+            job j;
+            ss >> j.id;
+            if (j.id.empty()) {
+                conn->send("ERROR - RENDER sem id\n");
+                continue;
+            }
+            for (std::string op; ss >> op;) j.opcoes.push_back(op);
+            j.conn = conn;
+            j.chegada = clock::now();
+
+            std::size_t n;
+            {
+                std::lock_guard<std::mutex> lock(mtx);
+                if (parando) {
+                    conn->send("ERROR " + j.id + " servidor encerrando\n");
+                    continue;
+                }
+                fila.push_back(std::move(j));
+                n = fila.size();
+            }
+            metricas.received(n);
+            cv.notify_one();
+        }
+    }
+
+    // atende a fila até parar e esvaziar
+    void run_jobs() {
+        for (;;) {
+            job j;
+            {
+                std::unique_lock<std::mutex> lock(mtx);
+                cv.wait(lock, [this] { return parando || !fila.empty(); });
+                if (fila.empty()) return;
+                j = std::move(fila.front());
+                fila.pop_front();
+                metricas.dequeued(fila.size());
+            }
+            if (j.conn->closed) {
+                metricas.canceled();
+                continue;
+            }
+            run_job(j);
+        }
+    }
+
+    void run_job(const job& j) {
+        auto inicio = clock::now();
+        double ms_fila = std::chrono::duration<double, std::milli>(inicio - j.chegada).count();
+        std::uint64_t raios = 0;
+        std::string resposta;
+        bool ok = true;
+        try {
+            args opcoes(j.opcoes);
+            std::string chave = handlers.scene_key(opcoes);
+            auto* pronto = cenarios.get(chave);
+            bool hit = pronto != nullptr;
+            std::shared_ptr<const scene> cena = hit ? *pronto : cenarios.put(chave, handlers.build(opcoes));
+            metricas.cache(hit, cenarios.size(), cenarios.evictions());
+
+            framebuffer fb;
+            raios = handlers.render(opcoes, *cena, fb);
+            std::ostringstream ppm;
+            fb.write_ppm(ppm);
+            std::string img = ppm.str();
+
+            double ms_render = std::chrono::duration<double, std::milli>(clock::now() - inicio).count();
+            std::ostringstream cab;
+            cab << std::fixed << std::setprecision(1) << "IMAGE " << j.id << ' ' << img.size() << ' '
+                << ms_fila << ' ' << ms_render << ' ' << (hit ? "hit" : "miss") << '\n';
+            resposta = cab.str() + img;
+        } catch (const std::exception& e) {
+            ok = false;
+            resposta = "ERROR " + j.id + ' ' + e.what() + '\n';
+        }
+        j.conn->send(resposta);
+        double ms_total = std::chrono::duration<double, std::milli>(clock::now() - j.chegada).count();
+        metricas.finished(ok, ms_fila, ms_total, raios);
+    }
+};
+
+#else
+
+// sem sockets unix nem fork/pipes no windows: só avisa
+class render_server {
+  public:
+    render_server(server_handlers, std::size_t) {}
+
+    int serve_stdio() {
+        std::clog << "--servidor não é suportado no windows\n";
+        return 1;
+    }
+
+    int serve_unix(const std::string&) { return serve_stdio(); }
+};
+
+#endif
+
+#endif
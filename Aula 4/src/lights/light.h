@@ -0,0 +1,236 @@
+#ifndef LIGHT_H
+#define LIGHT_H
+
+#include "../accel/aabb.h"
+#include "../colors/color.h"
+#include "../objects/hittable.h"
+#include "../ray/ray.h"
+#include "../vectors/vec3.h"
+
+#include <algorithm>
+#include <cmath>
+#include <memory>
+#include <vector>
+
+/**
+ * fonte de luz: pontual ou de área (retângulo, disco ou esfera)
+ *
+ * uma luz de área é tratada como uma grade grid x grid de fontes
+ * pontuais, uma em cada estrato da superfície, cada uma com
+ * intensity / (grid * grid). as amostras dos quatro cantos da grade
+ * são testadas primeiro; o resto só é traçado se elas discordarem,
+ * ou seja, na penumbra.
+ *
+ * light linking: se 'linked' não estiver vazio, só esses objetos
+ * podem fazer sombra para esta luz. 'occluders' é a estrutura que os
+ * raios de sombra realmente testam, montada por scene::build().
+ */
+class light {
+  public:
+    enum class shape { point, rectangle, disk, sphere };
+
+    shape kind = shape::point;
+    // centro da luz
+    point3 position;
+    color intensity;
+    // retângulo: arestas (centradas em position); disco: eixos do plano
+    vec3 edge_u, edge_v;
+    // disco e esfera
+    double radius = 0.0;
+    // amostras de sombra: grid * grid estratos
+    int grid = 1;
+
+    std::vector<std::shared_ptr<hittable>> linked;
+    std::shared_ptr<hittable> occluders;
+
+    static light point(const point3& p, const color& i) {
+        light l;
+        l.position = p;
+        l.intensity = i;
+        return l;
+    }
+
+    // retângulo com centro c e arestas u, v
+    static light rectangle(const point3& c, const vec3& u, const vec3& v, const color& i, int grid = 4) {
+        light l = point(c, i);
+        l.kind = shape::rectangle;
+        l.edge_u = u;
+        l.edge_v = v;
+        l.grid = grid;
+        return l;
+    }
+
+    // disco com centro c, normal n e raio r
+    static light disk(const point3& c, const vec3& n, double r, const color& i, int grid = 4) {
+        light l = point(c, i);
+        l.kind = shape::disk;
+        l.radius = r;
+        l.grid = grid;
+        tangentes(unit_vector(n), l.edge_u, l.edge_v);
+        return l;
+    }
+
+    static light sphere(const point3& c, double r, const color& i, int grid = 4) {
+        light l = point(c, i);
+        l.kind = shape::sphere;
+        l.radius = r;
+        l.grid = grid;
+        return l;
+    }
+
+    bool is_area() const { return kind != shape::point && grid > 1; }
+
+    int sample_count() const { return is_area() ? grid * grid : 1; }
+
+    /**
+     * ponto da luz no estrato (i, j) da grade, deslocado por (su, sv)
+     * dentro dele (su, sv em [0, 1)). 'p' é o ponto sombreado: a esfera
+     * é amostrada pelo disco da sua silhueta vista de p.
+     */
+    point3 sample(int i, int j, double su, double sv, const point3& p) const {
+        if (!is_area()) return position;
+        double s = (i + su) / grid;
+        double t = (j + sv) / grid;
+
+        switch (kind) {
+        case shape::rectangle:
+            return position + (s - 0.5) * edge_u + (t - 0.5) * edge_v;
+        case shape::disk:
+            return position + disco(s, t, edge_u, edge_v);
+        case shape::sphere: {
+            vec3 u, v;
+            tangentes(unit_vector(p - position), u, v);
+            return position + disco(s, t, u, v);
+        }
+        default:
+            return position;
+        }
+    }
+
+    // ---- geometria da superfície, usada pelo path tracer ----
+
+    // área da superfície emissora (zero para a pontual)
+    double area() const {
+        const double pi = 3.1415926535897932385;
+        switch (kind) {
+        case shape::rectangle: return cross(edge_u, edge_v).length();
+        case shape::disk: return pi * radius * radius;
+        case shape::sphere: return 4 * pi * radius * radius;
+        default: return 0.0;
+        }
+    }
+
+    /**
+     * ponto uniforme na superfície (por área) para (s, t) em [0, 1)^2,
+     * com a normal do lado que emite. retângulo e disco emitem só para
+     * o lado de cross(edge_u, edge_v); a esfera, para fora.
+     */
+    point3 sample_surface(double s, double t, vec3& normal) const {
+        const double pi = 3.1415926535897932385;
+        switch (kind) {
+        case shape::rectangle:
+            normal = unit_vector(cross(edge_u, edge_v));
+            return position + (s - 0.5) * edge_u + (t - 0.5) * edge_v;
+        case shape::disk:
+            normal = unit_vector(cross(edge_u, edge_v));
+            return position + disco(s, t, edge_u, edge_v);
+        case shape::sphere: {
+            double z = 1 - 2 * s;
+            double r = std::sqrt(std::fmax(0.0, 1 - z * z));
+            double phi = 2 * pi * t;
+            normal = vec3(r * std::cos(phi), r * std::sin(phi), z);
+            return position + radius * normal;
+        }
+        default:
+            normal = vec3(0, 0, 0);
+            return position;
+        }
+    }
+
+    // o raio atinge a superfície pelo lado que emite em (tmin, tmax)?
+    // devolve t e a normal do lado que emite
+    bool intersect(const ray& r, double tmin, double tmax, double& t, vec3& normal) const {
+        const vec3& d = r.direction();
+        switch (kind) {
+        case shape::rectangle:
+        case shape::disk: {
+            vec3 n = unit_vector(cross(edge_u, edge_v));
+            double den = dot(n, d);
+            if (den >= 0) return false;
+            t = dot(position - r.origin(), n) / den;
+            if (t <= tmin || t >= tmax) return false;
+            vec3 q = r.at(t) - position;
+            if (kind == shape::disk) {
+                if (q.length_squared() > radius * radius) return false;
+            } else {
+                double a = dot(q, edge_u) / edge_u.length_squared();
+                double b = dot(q, edge_v) / edge_v.length_squared();
+                if (std::fabs(a) > 0.5 || std::fabs(b) > 0.5) return false;
+            }
+            normal = n;
+            return true;
+        }
+        case shape::sphere: {
+            vec3 oc = position - r.origin();
+            double a = d.length_squared();
+            double h = dot(d, oc);
+            double disc = h * h - a * (oc.length_squared() - radius * radius);
+            if (disc < 0) return false;
+            // só o lado de fora emite: a raiz mais próxima
+            t = (h - std::sqrt(disc)) / a;
+            if (t <= tmin || t >= tmax) return false;
+            normal = (r.at(t) - position) / radius;
+            return true;
+        }
+        default:
+            return false;
+        }
+    }
+
+    // caixa que contém todos os pontos que sample() pode devolver
+    aabb bounding_box() const {
+        switch (kind) {
+        case shape::rectangle: {
+            aabb b(position - 0.5 * edge_u - 0.5 * edge_v, position + 0.5 * edge_u - 0.5 * edge_v);
+            b.expand(position - 0.5 * edge_u + 0.5 * edge_v);
+            b.expand(position + 0.5 * edge_u + 0.5 * edge_v);
+            return b;
+        }
+        case shape::disk:
+            return disc_box(position, unit_vector(cross(edge_u, edge_v)), radius);
+        case shape::sphere: {
+            vec3 r(radius, radius, radius);
+            return aabb(position - r, position + r);
+        }
+        default:
+            return aabb(position, position);
+        }
+    }
+
+  private:
+    // base ortonormal (u, v) do plano perpendicular a n
+    static void tangentes(const vec3& n, vec3& u, vec3& v) {
+        vec3 a = std::fabs(n.x()) > 0.9 ? vec3(0, 1, 0) : vec3(1, 0, 0);
+        u = unit_vector(cross(a, n));
+        v = cross(n, u);
+    }
+
+    // mapeamento concêntrico do quadrado [0,1)^2 no disco de raio 'radius'
+    // (preserva a estratificação)
+    vec3 disco(double s, double t, const vec3& u, const vec3& v) const {
+        const double pi = 3.1415926535897932385;
+        double a = 2 * s - 1, b = 2 * t - 1;
+        if (a == 0 && b == 0) return vec3(0, 0, 0);
+        double r, phi;
+        if (std::fabs(a) > std::fabs(b)) {
+            r = a;
+            phi = (pi / 4) * (b / a);
+        } else {
+            r = b;
+            phi = (pi / 2) - (pi / 4) * (a / b);
+        }
+        return radius * r * (std::cos(phi) * u + std::sin(phi) * v);
+    }
+};
+
+#endif
@@ -17,9 +17,18 @@ class material {
     color k_specular;
     // expoente especular
     int shininess;
+    // refletância do espelho (0 = sem reflexo)
+    color k_reflect = color(0, 0, 0);
+    // transmitância (0 = opaco) e índice de refração
+    color k_transmit = color(0, 0, 0);
+    double ior = 1.5;
 
     material(const color& ka, const color& kd, const color& ks, int m)
       : k_ambient(ka), k_diffuse(kd), k_specular(ks), shininess(m) {}
+
+    bool specular() const { return k_specular.x() > 0 || k_specular.y() > 0 || k_specular.z() > 0; }
+    bool reflective() const { return k_reflect.x() > 0 || k_reflect.y() > 0 || k_reflect.z() > 0; }
+    bool transmissive() const { return k_transmit.x() > 0 || k_transmit.y() > 0 || k_transmit.z() > 0; }
 };
 
 #endif
\ No newline at end of file
@@ -52,6 +52,28 @@ class cilindro : public hittable {
             return hit_anything;
         }
 
+        // atualização para cenas animadas (reajustar o bvh depois)
+        // recalcula os termos pré-calculados no construtor
+        void set_base(const point3& c) {
+            centroBase = c;
+            centroTopo = centroBase + u*h;
+        }
+
+        void set_axis(const vec3& dir) {
+            u = unit_vector(dir);
+            centroTopo = centroBase + u*h;
+        }
+
+        const point3& get_base() const { return centroBase; }
+        const vec3& get_axis() const { return u; }
+
+        // união das caixas dos dois discos (fundo e tampa)
+        aabb bounding_box() const override {
+            // folga relativa: acertos nas bordas das tampas saem ~1e-8
+            // da caixa exata e o bvh os descartaria
+            return aabb(disc_box(centroBase, u, raio), disc_box(centroTopo, u, raio)).padded(1e-6 * (h + raio));
+        }
+
     private:
         point3 centroBase;
         double h;
@@ -88,9 +110,10 @@ class cilindro : public hittable {
             // bhaskara
             auto sqrtd = std::sqrt(delta);
             
+            divide_by sobre_2a(2*a);
             double raizes[] = {
-                (-b - sqrtd)/(2*a),
-                (-b + sqrtd)/(2*a)
+                sobre_2a(-b - sqrtd),
+                sobre_2a(-b + sqrtd)
             };
 
             bool hit = false;
@@ -109,6 +132,7 @@ class cilindro : public hittable {
                 // cálculo da normal
                 b_rec.normal = unit_vector((p - centroBase) - dot(p - centroBase, u) * u);
                 b_rec.mat = m;
+                b_rec.obj = this;
             }
 
             if (hit) {
@@ -139,6 +163,7 @@ class cilindro : public hittable {
             temp_rec.p = p;
             temp_rec.normal = normal;
             temp_rec.mat = m;
+            temp_rec.obj = this;
 
             return true;
         }
@@ -164,6 +189,7 @@ class cilindro : public hittable {
             temp_rec.p = p;
             temp_rec.normal = normal;
             temp_rec.mat = m;
+            temp_rec.obj = this;
 
             return true;
         }
@@ -47,6 +47,29 @@ class cone : public hittable {
             return hit_anything;
         }
 
+        // atualização para cenas animadas (reajustar o bvh depois)
+        void set_base(const point3& c) {
+            centroBase = c;
+            vertice = centroBase + u*h;
+        }
+
+        void set_axis(const vec3& dir) {
+            u = unit_vector(dir);
+            vertice = centroBase + u*h;
+        }
+
+        const point3& get_base() const { return centroBase; }
+        const vec3& get_axis() const { return u; }
+
+        // caixa do disco da base expandida até o vértice
+        aabb bounding_box() const override {
+            aabb box = disc_box(centroBase, u, raio);
+            box.expand(vertice);
+            // perto do vértice a raiz é mal condicionada e o ponto calculado
+            // sai ~1e-8 da caixa exata: sem a folga o bvh o descartaria
+            return box.padded(1e-6 * (h + raio));
+        }
+
     private:
         point3 centroBase;
         double h;
@@ -83,7 +106,8 @@ class cone : public hittable {
             if (delta < 0.0) return false;
             double sqrtd = std::sqrt(delta);
 
-            double raizes[] = { (-b - sqrtd) / a, (-b + sqrtd) / a };
+            divide_by sobre_a(a);
+            double raizes[] = { sobre_a(-b - sqrtd), sobre_a(-b + sqrtd) };
 
             bool hit = false;
             hit_record rec;
@@ -112,6 +136,7 @@ class cone : public hittable {
                 rec.p = P;
                 rec.normal = normal;
                 rec.mat = m;
+                rec.obj = this;
             }
 
             if (hit) temp_rec = rec;
@@ -138,6 +163,7 @@ class cone : public hittable {
             temp_rec.p = p;
             temp_rec.normal = normal;
             temp_rec.mat = m;
+            temp_rec.obj = this;
             return true;
         }
 };
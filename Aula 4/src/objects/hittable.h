@@ -3,8 +3,11 @@
 
 #include "../ray/ray.h"
 #include "../material/material.h"
+#include "../accel/aabb.h"
 #include <memory>
 
+class hittable;
+
 class hit_record {
   public:
     // Ponto de interseção
@@ -12,13 +15,31 @@ class hit_record {
     vec3 normal;
     double t;
     std::shared_ptr<material> mat;
+    // objeto atingido (a instância, quando houver uma no caminho)
+    const hittable* obj = nullptr;
 };
 
 class hittable {
   public:
+    // o objeto bloqueia a luz (entra nos testes de sombra)
+    bool casts_shadows = true;
+    // o objeto pode ficar na sombra (se não, o teste de sombra é pulado)
+    bool receives_shadows = true;
+
     virtual ~hittable() = default;
 
     virtual bool hit(const ray& r, double ray_tmin, double ray_tmax, hit_record& rec) const = 0;
+
+    // existe alguma interseção em (tmin, tmax) com um objeto que faz
+    // sombra? usado pelos raios de sombra, que não precisam da mais próxima
+    virtual bool hit_any(const ray& r, double ray_tmin, double ray_tmax) const {
+        hit_record rec;
+        return hit(r, ray_tmin, ray_tmax, rec);
+    }
+
+    // caixa envolvente do objeto
+    // objetos ilimitados (planos) devolvem aabb::universe()
+    virtual aabb bounding_box() const = 0;
 };
 
 #endif
\ No newline at end of file
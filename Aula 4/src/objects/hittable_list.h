@@ -21,12 +21,13 @@ class hittable_list : public hittable {
     hittable_list(shared_ptr<hittable> object) { add(object); }
 
     // O(n)
-    void clear() { objects.clear(); }
+    void clear() { objects.clear(); bbox = aabb(); }
 
     // adiciona um objeto no cenário
     // O(1)
     void add(shared_ptr<hittable> object) {
         objects.push_back(object);
+        bbox.expand(object->bounding_box());
     }
 
     // itera sobre todos os objetos do cenário
@@ -47,6 +48,18 @@ class hittable_list : public hittable {
 
         return hit_anything;
     }
+
+    // para na primeira interseção
+    bool hit_any(const ray& r, double ray_tmin, double ray_tmax) const override {
+        for (const auto& object : objects)
+            if (object->casts_shadows && object->hit_any(r, ray_tmin, ray_tmax)) return true;
+        return false;
+    }
+
+    aabb bounding_box() const override { return bbox; }
+
+  private:
+    aabb bbox;
 };
 
 #endif
\ No newline at end of file
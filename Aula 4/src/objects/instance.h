@@ -0,0 +1,70 @@
+#ifndef INSTANCE_H
+#define INSTANCE_H
+
+#include "hittable.h"
+#include "../vectors/transform.h"
+#include <memory>
+
+/**
+ * cópia posicionada de um objeto compartilhado
+ *
+ * a geometria (normalmente um bvh de um sub-cenário) é guardada
+ * uma única vez; cada instância guarda só um ponteiro e a sua
+ * transformação. N cópias custam O(1) em geometria e O(N) em
+ * transformações.
+ *
+ * o raio é levado para o espaço do objeto com a transformação inversa.
+ * como a direção não é normalizada, o t da interseção é o mesmo nos
+ * dois espaços; ponto e normal são levados de volta para o mundo.
+ */
+class instance : public hittable {
+  public:
+    instance(std::shared_ptr<hittable> object, const transform& xf)
+      : object(object), xf(xf) {}
+
+    bool hit(const ray& r, double ray_tmin, double ray_tmax, hit_record& rec) const override {
+        ray r_obj(xf.inv_point(r.origin()), xf.inv_vector(r.direction()));
+
+        if (!object->hit(r_obj, ray_tmin, ray_tmax, rec))
+            return false;
+
+        rec.p = xf.point(rec.p);
+        rec.normal = unit_vector(xf.normal(rec.normal));
+        rec.obj = this;
+        return true;
+    }
+
+    bool hit_any(const ray& r, double ray_tmin, double ray_tmax) const override {
+        ray r_obj(xf.inv_point(r.origin()), xf.inv_vector(r.direction()));
+        return object->hit_any(r_obj, ray_tmin, ray_tmax);
+    }
+
+    // muda a posição da cópia; o bvh que contém a instância
+    // deve ser reajustado depois (bvh::refit ou bvh::update)
+    void set_transform(const transform& t) { xf = t; }
+    const transform& get_transform() const { return xf; }
+
+    // caixa no mundo: transforma os 8 cantos da caixa do objeto
+    // calculada na hora para acompanhar mudanças no objeto compartilhado
+    aabb bounding_box() const override {
+        aabb box = object->bounding_box();
+        if (!box.is_finite()) return aabb::universe();
+
+        aabb out;
+        for (int i = 0; i < 8; ++i) {
+            point3 canto(
+                (i & 1) ? box.pmax.x() : box.pmin.x(),
+                (i & 2) ? box.pmax.y() : box.pmin.y(),
+                (i & 4) ? box.pmax.z() : box.pmin.z()
+            );
+            out.expand(xf.point(canto));
+        }
+        return out;
+    }
+
+  private:
+    std::shared_ptr<hittable> object;
+    transform xf;
+};
+
+#endif
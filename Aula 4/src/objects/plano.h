@@ -36,6 +36,7 @@ class plane : public hittable {
         rec.p = r.at(t);
         
         rec.mat = mat;
+        rec.obj = this;
 
         // Define a normal. A normal deve sempre apontar "contra" o raio que a atingiu.
         // Se o produto escalar da direção do raio e da normal for positivo,
@@ -49,6 +50,12 @@ class plane : public hittable {
         return true;
     }
 
+    const point3& get_point() const { return point_on_plane; }
+    const vec3& get_normal() const { return normal; }
+
+    // o plano é infinito, não tem caixa finita
+    aabb bounding_box() const override { return aabb::universe(); }
+
   private:
     point3 point_on_plane;
     vec3 normal;
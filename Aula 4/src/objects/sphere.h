@@ -28,9 +28,10 @@ class sphere : public hittable {
         auto sqrtd = std::sqrt(discriminant);
 
         // Find the nearest root that lies in the acceptable range.
-        auto root = (h - sqrtd) / a;
+        divide_by sobre_a(a);
+        auto root = sobre_a(h - sqrtd);
         if (root <= ray_tmin || ray_tmax <= root) {
-            root = (h + sqrtd) / a;
+            root = sobre_a(h + sqrtd);
             if (root <= ray_tmin || ray_tmax <= root)
                 return false;
         }
@@ -39,10 +40,22 @@ class sphere : public hittable {
         rec.p = r.at(rec.t);
         rec.normal = (rec.p - center) / radius;
         rec.mat = mat;
+        rec.obj = this;
 
         return true;
     }
 
+    // atualização para cenas animadas (reajustar o bvh depois)
+    void set_center(const point3& c) { center = c; }
+    void set_radius(double r) { radius = std::fmax(0, r); }
+    const point3& get_center() const { return center; }
+    double get_radius() const { return radius; }
+
+    aabb bounding_box() const override {
+        vec3 r(radius, radius, radius);
+        return aabb(center - r, center + r);
+    }
+
   private:
     point3 center;
     double radius;
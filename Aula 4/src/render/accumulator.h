@@ -0,0 +1,77 @@
+#ifndef ACCUMULATOR_H
+#define ACCUMULATOR_H
+
+#include "../colors/color.h"
+#include "framebuffer.h"
+
+#include <cmath>
+#include <vector>
+
+// luminância (Rec. 709), usada como medida escalar de erro
+inline double luminance(const color& c) {
+    return 0.2126 * c.x() + 0.7152 * c.y() + 0.0722 * c.z();
+}
+
+/**
+ * framebuffer de acumulação: soma das amostras de cada pixel,
+ * soma dos quadrados da luminância e quantidade de amostras
+ *
+ * cada pixel só é escrito pela thread dona do seu tile
+ */
+class accumulator {
+  public:
+    int width = 0;
+    int height = 0;
+    std::vector<color> sum;
+    std::vector<double> sum_y2;
+    std::vector<int> count;
+
+    accumulator() {}
+    accumulator(int w, int h)
+      : width(w), height(h), sum(size_t(w) * h), sum_y2(size_t(w) * h, 0.0), count(size_t(w) * h, 0) {}
+
+    size_t index(int c, int l) const { return size_t(l) * width + c; }
+
+    void add(int c, int l, const color& amostra) {
+        size_t i = index(c, l);
+        sum[i] += amostra;
+        double y = luminance(amostra);
+        sum_y2[i] += y * y;
+        count[i]++;
+    }
+
+    int samples(int c, int l) const { return count[index(c, l)]; }
+
+    color mean(int c, int l) const {
+        size_t i = index(c, l);
+        return count[i] > 0 ? sum[i] / count[i] : color(0, 0, 0);
+    }
+
+    // erro padrão da média da luminância (precisa de 2+ amostras)
+    double std_error(int c, int l) const {
+        size_t i = index(c, l);
+        int n = count[i];
+        if (n < 2) return 0.0;
+        double m = luminance(sum[i]) / n;
+        double var = std::fmax(0.0, (sum_y2[i] / n - m * m) * n / (n - 1));
+        return std::sqrt(var / n);
+    }
+
+    // imagem final: média de cada pixel
+    // pixels sem amostra repetem a amostra mais próxima da grade
+    // grossa (múltiplos de 'passo'), se houver
+    framebuffer resolve(int passo = 8) const {
+        framebuffer fb(width, height);
+        for (int l = 0; l < height; ++l) {
+            for (int c = 0; c < width; ++c) {
+                if (count[index(c, l)] > 0)
+                    fb.at(c, l) = mean(c, l);
+                else
+                    fb.at(c, l) = mean(c - c % passo, l - l % passo);
+            }
+        }
+        return fb;
+    }
+};
+
+#endif
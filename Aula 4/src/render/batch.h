@@ -0,0 +1,124 @@
+#ifndef BATCH_H
+#define BATCH_H
+
+#include "camera.h"
+#include "framebuffer.h"
+#include "render_stats.h"
+#include "renderer.h"
+#include "thread_pool.h"
+
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+#include <istream>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <vector>
+
+// uma vista do lote: nome (usado no arquivo de saída) e câmera
+struct camera_def {
+    std::string name;
+    camera cam;
+};
+
+/**
+ * lê a lista de câmeras, uma por linha:
+ *
+ *   nome  ox oy oz  ax ay az  [nCol nLin]
+ *
+ * olho em (ox, oy, oz) olhando para (ax, ay, az), janela padrão.
+ * linhas vazias e começadas por '#' são ignoradas.
+ */
+inline std::vector<camera_def> read_camera_list(std::istream& in) {
+    std::vector<camera_def> lista;
+    std::string linha;
+    while (std::getline(in, linha)) {
+        std::istringstream ss(linha);
+        camera_def def;
+        double ox, oy, oz, ax, ay, az;
+        if (!(ss >> def.name) || def.name[0] == '#') continue;
+        if (!(ss >> ox >> oy >> oz >> ax >> ay >> az)) continue;
+
+        int nc, nl;
+        if (ss >> nc >> nl) {
+            def.cam.nCol = nc;
+            def.cam.nLin = nl;
+        }
+        def.cam.look_at(point3(ox, oy, oz), point3(ax, ay, az));
+        lista.push_back(def);
+    }
+    return lista;
+}
+
+// n câmeras em círculo (giro) em volta de 'centro', na altura do olho
+inline std::vector<camera_def> turntable(int n, const point3& centro, double raio, double altura = 0.0) {
+    std::vector<camera_def> lista;
+    for (int i = 0; i < n; ++i) {
+        double ang = 2.0 * 3.1415926535897932385 * i / n;
+        camera_def def;
+        def.name = "giro_" + std::to_string(i);
+        def.cam.look_at(centro + vec3(raio * std::sin(ang), altura, raio * std::cos(ang)), centro);
+        lista.push_back(def);
+    }
+    return lista;
+}
+
+/**
+ * renderiza todas as vistas sobre o mesmo cenário já construído
+ *
+ * os tiles de todas as vistas entram em uma única distribuição no
+ * pool, sem barreira entre uma vista e outra. cada framebuffer é
+ * criado no primeiro tile da vista e liberado logo depois de
+ * on_view(i, fb), chamada por quem terminar o último tile da vista
+ * (em qualquer thread, fora de ordem). assim só as vistas em
+ * andamento ocupam memória.
+ * shade(cam, c, l) devolve a cor do pixel (c, l) da câmera cam.
+ */
+template <class Shade, class OnView>
+std::uint64_t render_batch(thread_pool& pool, const std::vector<camera_def>& vistas, int tile_size,
+                           const Shade& shade, const OnView& on_view) {
+    struct trabalho {
+        int vista;
+        tile t;
+    };
+
+    int n = int(vistas.size());
+    std::vector<std::unique_ptr<framebuffer>> fbs(n);
+    std::vector<std::once_flag> criado(n);
+    std::vector<std::atomic<int>> restantes(n);
+    std::vector<trabalho> trabalhos;
+    for (int i = 0; i < n; ++i) {
+        const camera& cam = vistas[i].cam;
+        auto tiles = make_tiles(cam.nCol, cam.nLin, tile_size);
+        restantes[i] = int(tiles.size());
+        for (const tile& t : tiles)
+            trabalhos.push_back({i, t});
+    }
+
+    std::atomic<std::uint64_t> raios{0};
+    pool.parallel_for(int(trabalhos.size()), [&](int k) {
+        const trabalho& tr = trabalhos[k];
+        const camera& cam = vistas[tr.vista].cam;
+        std::call_once(criado[tr.vista], [&] {
+            fbs[tr.vista] = std::make_unique<framebuffer>(cam.nCol, cam.nLin);
+        });
+
+        framebuffer& fb = *fbs[tr.vista];
+        std::uint64_t antes = rays_traced();
+        for (int l = tr.t.y0; l < tr.t.y1; ++l)
+            for (int c = tr.t.x0; c < tr.t.x1; ++c)
+                fb.at(c, l) = shade(cam, c, l);
+        raios += rays_traced() - antes;
+
+        if (--restantes[tr.vista] == 0) {
+            on_view(tr.vista, fb);
+            fbs[tr.vista].reset();
+        }
+    });
+
+    return raios;
+}
+
+#endif
@@ -0,0 +1,155 @@
+#ifndef BUDGET_H
+#define BUDGET_H
+
+#include "accumulator.h"
+#include "render_stats.h"
+#include "renderer.h"
+#include "thread_pool.h"
+#include "../util/rng.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <numeric>
+#include <vector>
+
+struct budget_result {
+    int passes = 0;
+    std::uint64_t rays = 0;
+    double mean_spp = 0.0;
+    // true se a imagem convergiu antes do prazo
+    bool converged = false;
+};
+
+/**
+ * renderização com orçamento de tempo
+ *
+ * 1. grade grossa (1 pixel a cada 8x8): sempre roda, garante uma
+ *    imagem completa mesmo com prazo muito curto;
+ * 2. uma amostra no centro de cada pixel;
+ * 3. refinamento adaptativo até o prazo: os tiles com mais erro vão
+ *    primeiro, e só os pixels com erro acima de 'limiar' ganham
+ *    amostras novas (com jitter dentro do pixel). o número de amostras
+ *    por passada dobra até 'max_spp'.
+ *
+ * o cancelamento é cooperativo: as threads olham o prazo antes de
+ * pegar cada tile, nunca no meio de um. um tile parcial de uma passada
+ * só deixa alguns pixels com mais amostras, então a imagem acumulada
+ * está sempre consistente.
+ *
+ * shade(c, l, su, sv, amostra) devolve uma amostra do pixel (c, l)
+ * no ponto (su, sv) do pixel; 'amostra' é o índice da amostra no pixel,
+ * para quem precisar de mais dimensões aleatórias.
+ */
+template <class Shade>
+budget_result render_budget(thread_pool& pool, accumulator& acc, int tile_size,
+                            std::chrono::steady_clock::time_point prazo, const Shade& shade,
+                            int max_spp = 64, double limiar = 0.005) {
+    using clock = std::chrono::steady_clock;
+    budget_result res;
+    std::atomic<std::uint64_t> raios{0};
+
+    auto amostrar = [&](int c, int l) {
+        int k = acc.samples(c, l);
+        if (k == 0) {
+            acc.add(c, l, shade(c, l, 0.5, 0.5, 0));
+        } else {
+            rng g(pixel_seed(c, l, k));
+            acc.add(c, l, shade(c, l, g.uniform(), g.uniform(), k));
+        }
+    };
+
+    // 1. grade grossa, sem cancelamento
+    int passo = 8;
+    pool.parallel_for((acc.height + passo - 1) / passo, [&](int i) {
+        std::uint64_t antes = rays_traced();
+        for (int c = 0; c < acc.width; c += passo) amostrar(c, i * passo);
+        raios += rays_traced() - antes;
+    });
+    res.passes = 1;
+
+    auto tiles = make_tiles(acc.width, acc.height, tile_size);
+    std::atomic<bool> cancelado{false};
+
+    auto roda_tiles = [&](const std::vector<int>& ordem, auto&& por_pixel) {
+        pool.parallel_for(int(ordem.size()), [&](int i) {
+            if (cancelado) return;
+            if (clock::now() >= prazo) { cancelado = true; return; }
+            const tile& t = tiles[ordem[i]];
+            std::uint64_t antes = rays_traced();
+            for (int l = t.y0; l < t.y1; ++l)
+                for (int c = t.x0; c < t.x1; ++c)
+                    por_pixel(c, l);
+            raios += rays_traced() - antes;
+        });
+    };
+
+    std::vector<int> ordem(tiles.size());
+    std::iota(ordem.begin(), ordem.end(), 0);
+
+    // 2. uma amostra por pixel
+    roda_tiles(ordem, [&](int c, int l) {
+        if (acc.samples(c, l) == 0) amostrar(c, l);
+    });
+    if (!cancelado) res.passes++;
+
+    // erro de um pixel: com 1 amostra, o contraste com os vizinhos;
+    // com mais, o erro padrão da média
+    auto erro = [&](int c, int l) {
+        int n = acc.samples(c, l);
+        if (n == 0) return 1.0;
+        if (n >= 2) return acc.std_error(c, l);
+        double y = luminance(acc.mean(c, l));
+        double maior = 0.0;
+        const int dc[] = {1, -1, 0, 0}, dl[] = {0, 0, 1, -1};
+        for (int k = 0; k < 4; ++k) {
+            int cc = c + dc[k], ll = l + dl[k];
+            if (cc < 0 || ll < 0 || cc >= acc.width || ll >= acc.height) continue;
+            if (acc.samples(cc, ll) == 0) continue;
+            maior = std::max(maior, std::fabs(y - luminance(acc.mean(cc, ll))));
+        }
+        // converte contraste em uma estimativa grosseira de erro
+        return maior * 0.1;
+    };
+
+    // 3. refinamento adaptativo
+    // o erro lê pixels vizinhos, então é medido numa etapa só de leitura
+    // e guardado em 'precisa' antes de qualquer tile receber amostras
+    std::vector<double> erro_tile(tiles.size());
+    std::vector<char> precisa(acc.count.size());
+    for (int spp = 2; !cancelado && spp <= max_spp; spp *= 2) {
+        pool.parallel_for(int(tiles.size()), [&](int i) {
+            const tile& t = tiles[i];
+            double e = 0.0;
+            for (int l = t.y0; l < t.y1; ++l) {
+                for (int c = t.x0; c < t.x1; ++c) {
+                    double x = erro(c, l) - limiar;
+                    precisa[acc.index(c, l)] = x > 0;
+                    e += std::max(0.0, x);
+                }
+            }
+            erro_tile[i] = e;
+        });
+
+        ordem.clear();
+        for (int i = 0; i < int(tiles.size()); ++i)
+            if (erro_tile[i] > 0) ordem.push_back(i);
+        if (ordem.empty()) break;
+        std::sort(ordem.begin(), ordem.end(), [&](int a, int b) { return erro_tile[a] > erro_tile[b]; });
+
+        roda_tiles(ordem, [&](int c, int l) {
+            if (!precisa[acc.index(c, l)]) return;
+            while (acc.samples(c, l) < spp) amostrar(c, l);
+        });
+        if (!cancelado) res.passes++;
+    }
+
+    res.converged = !cancelado;
+    res.rays = raios;
+    res.mean_spp = double(std::accumulate(acc.count.begin(), acc.count.end(), 0LL)) / acc.count.size();
+    return res;
+}
+
+#endif
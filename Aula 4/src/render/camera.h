@@ -0,0 +1,80 @@
+#ifndef CAMERA_H
+#define CAMERA_H
+
+#include "../ray/ray.h"
+#include "../vectors/vec3.h"
+
+/**
+ * olho + janela, o mesmo mapeamento pixel -> janela que o main()
+ * sempre usou: a janela fica no plano z = -dJanela e o pixel (c, l)
+ * corresponde ao centro da sua célula na "tela de mosquito"
+ *
+ * a orientação padrão olha para -z com y para cima; look_at() gira
+ * a janela para olhar de qualquer ponto para qualquer alvo
+ */
+class camera {
+  public:
+    // propriedades da janela
+    double wJanela = 60.0;
+    double hJanela = 60.0;
+    double dJanela = 30.0;
+
+    // olho do pintor
+    point3 zoio = point3(0, 0, 0);
+
+    int nCol = 500;
+    int nLin = 500;
+
+    // base da câmera: u (direita), v (cima), w (para trás)
+    vec3 u = vec3(1, 0, 0);
+    vec3 v = vec3(0, 1, 0);
+    vec3 w = vec3(0, 0, 1);
+
+    camera() {}
+
+    camera(double w, double h, double d, const point3& olho, int colunas, int linhas)
+      : wJanela(w), hJanela(h), dJanela(d), zoio(olho), nCol(colunas), nLin(linhas) {}
+
+    // coloca o olho em 'de' olhando para 'para'
+    void look_at(const point3& de, const point3& para, const vec3& vup = vec3(0, 1, 0)) {
+        zoio = de;
+        w = unit_vector(de - para);
+        u = unit_vector(cross(vup, w));
+        v = cross(w, u);
+        orientada = true;
+    }
+
+    double Dx() const { return wJanela / nCol; }
+    double Dy() const { return hJanela / nLin; }
+
+    // raio pelo centro do pixel (c, l)
+    ray get_ray(int c, int l) const {
+        auto x = -wJanela / 2.0 + Dx() / 2.0 + c * Dx();
+        auto y =  hJanela / 2.0 - Dy() / 2.0 - l * Dy();
+
+        return ray_through(x, y);
+    }
+
+    // raio por um ponto qualquer do pixel, (su, sv) em [0,1)²
+    ray get_ray(int c, int l, double su, double sv) const {
+        auto x = -wJanela / 2.0 + (c + su) * Dx();
+        auto y =  hJanela / 2.0 - (l + sv) * Dy();
+
+        return ray_through(x, y);
+    }
+
+  private:
+    bool orientada = false;
+
+    // raio do olho até o ponto (x, y) da janela
+    ray ray_through(double x, double y) const {
+        // sem look_at, a janela fica em coordenadas do mundo, como no main() original
+        if (!orientada) {
+            auto ponto_na_janela = point3(x, y, -dJanela);
+            return ray(zoio, ponto_na_janela - zoio);
+        }
+        return ray(zoio, x * u + y * v - dJanela * w);
+    }
+};
+
+#endif
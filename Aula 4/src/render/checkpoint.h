@@ -0,0 +1,233 @@
+#ifndef CHECKPOINT_H
+#define CHECKPOINT_H
+
+#include "accumulator.h"
+#include "ppm_stream.h"
+#include "render_stats.h"
+#include "renderer.h"
+#include "thread_pool.h"
+#include "../util/arquivo.h"
+#include "../util/rng.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+/**
+ * estado salvo de uma renderização longa: o framebuffer de acumulação
+ * e o mapa de tiles terminados
+ *
+ * formato binário (ordem de bytes da máquina):
+ *   "RTCK2\n", width, height, tile_size, spp (int32),
+ *   tamanho da chave do cenário (int32) e a chave,
+ *   n_tiles (int32), n_tiles bytes (1 = terminado),
+ *   sum (3 doubles por pixel), sum_y2 (double), count (int32)
+ */
+class checkpoint_state {
+  public:
+    int width = 0, height = 0, tile_size = 0, spp = 0;
+    // opções de cenário e sombreamento com que a renderização começou
+    std::string cenario;
+    std::vector<unsigned char> done;
+    accumulator acc;
+
+    enum class carga { ok, invalido, diferente };
+
+    bool save(const std::string& caminho) const {
+        return write_file_atomic(caminho, [&](std::ostream& out) {
+            out.write(magic, sizeof(magic) - 1);
+            put(out, width); put(out, height); put(out, tile_size); put(out, spp);
+            put(out, std::int32_t(cenario.size()));
+            out.write(cenario.data(), std::streamsize(cenario.size()));
+            put(out, std::int32_t(done.size()));
+            out.write(reinterpret_cast<const char*>(done.data()), std::streamsize(done.size()));
+            out.write(reinterpret_cast<const char*>(acc.sum.data()), std::streamsize(acc.sum.size() * sizeof(color)));
+            out.write(reinterpret_cast<const char*>(acc.sum_y2.data()), std::streamsize(acc.sum_y2.size() * sizeof(double)));
+            out.write(reinterpret_cast<const char*>(acc.count.data()), std::streamsize(acc.count.size() * sizeof(int)));
+        }, true);
+    }
+
+    // lê o arquivo se ele for desta renderização: width, height,
+    // tile_size, spp, cenario e done.size() já devem ter os valores
+    // esperados. o cabeçalho é conferido antes de qualquer alocação
+    carga load(const std::string& caminho) {
+        std::ifstream in(caminho, std::ios::binary);
+        char m[sizeof(magic) - 1];
+        if (!in.read(m, sizeof(m)) || std::memcmp(m, magic, sizeof(m)) != 0) return carga::invalido;
+
+        std::int32_t w = 0, h = 0, ts = 0, s = 0, n_chave = 0, n_tiles = 0;
+        get(in, w); get(in, h); get(in, ts); get(in, s); get(in, n_chave);
+        if (!in || n_chave < 0) return carga::invalido;
+        if (w != width || h != height || ts != tile_size || s != spp ||
+            size_t(n_chave) != cenario.size())
+            return carga::diferente;
+
+        std::string chave(size_t(n_chave), '\0');
+        in.read(&chave[0], n_chave);
+        get(in, n_tiles);
+        if (!in) return carga::invalido;
+        if (chave != cenario || size_t(n_tiles) != done.size()) return carga::diferente;
+
+        acc = accumulator(width, height);
+        in.read(reinterpret_cast<char*>(done.data()), n_tiles);
+        in.read(reinterpret_cast<char*>(acc.sum.data()), std::streamsize(acc.sum.size() * sizeof(color)));
+        in.read(reinterpret_cast<char*>(acc.sum_y2.data()), std::streamsize(acc.sum_y2.size() * sizeof(double)));
+        in.read(reinterpret_cast<char*>(acc.count.data()), std::streamsize(acc.count.size() * sizeof(int)));
+        return in ? carga::ok : carga::invalido;
+    }
+
+  private:
+    static constexpr char magic[] = "RTCK2\n";
+
+    static void put(std::ostream& out, std::int32_t v) { out.write(reinterpret_cast<const char*>(&v), sizeof(v)); }
+    static void get(std::istream& in, std::int32_t& v) { in.read(reinterpret_cast<char*>(&v), sizeof(v)); }
+};
+
+struct checkpoint_config {
+    std::string path;
+    // intervalos menores que 1 ms viram 1 ms
+    std::chrono::milliseconds interval{30000};
+    bool resume = false;
+    // chave das opções que mudam a imagem; resume exige a mesma chave
+    std::string scene_key;
+};
+
+/**
+ * renderização em tiles com checkpoints periódicos
+ *
+ * as threads de render só marcam o tile como terminado (store com
+ * release) e seguem adiante. uma thread separada, a cada intervalo,
+ * copia os pixels dos tiles recém-terminados para uma cópia própria
+ * e grava essa cópia de forma atômica: o render nunca espera a escrita.
+ *
+ * com resume, tiles terminados no arquivo são pulados e as faixas
+ * já completas saem logo no início do ppm.
+ *
+ * cada pixel recebe 'spp' amostras: a primeira no centro e as demais
+ * com jitter; shade(c, l, su, sv) devolve uma amostra.
+ * o ppm vai para 'out' em faixas, como no render normal.
+ * devolve false (sem escrever nada) se o checkpoint não corresponde
+ * a esta renderização.
+ */
+template <class Shade>
+bool render_checkpointed(thread_pool& pool, int width, int height, int tile_size, int spp,
+                         const checkpoint_config& cfg, std::ostream& out, const Shade& shade) {
+    auto tiles = make_tiles(width, height, tile_size);
+
+    checkpoint_state estado;
+    estado.width = width; estado.height = height;
+    estado.tile_size = tile_size; estado.spp = spp;
+    estado.cenario = cfg.scene_key;
+    estado.done.assign(tiles.size(), 0);
+
+    auto lido = cfg.resume ? estado.load(cfg.path) : checkpoint_state::carga::invalido;
+    if (lido == checkpoint_state::carga::diferente) {
+        std::clog << "checkpoint " << cfg.path << " não corresponde a esta renderização\n";
+        return false;
+    }
+    if (lido != checkpoint_state::carga::ok) {
+        if (cfg.resume) std::clog << "sem checkpoint válido em " << cfg.path << ", começando do zero\n";
+        estado.done.assign(tiles.size(), 0);
+        estado.acc = accumulator(width, height);
+    }
+
+    ppm_stream_writer writer(out, width, height, tile_size);
+
+    // acumulação viva (escrita pelas threads) e a cópia do checkpointer
+    accumulator acc = estado.acc;
+    std::vector<std::atomic<unsigned char>> done(tiles.size());
+    for (size_t i = 0; i < tiles.size(); ++i) done[i] = estado.done[i];
+
+    auto copia_tile = [&](const tile& t) {
+        for (int l = t.y0; l < t.y1; ++l) {
+            for (int c = t.x0; c < t.x1; ++c) {
+                size_t i = acc.index(c, l);
+                estado.acc.sum[i] = acc.sum[i];
+                estado.acc.sum_y2[i] = acc.sum_y2[i];
+                estado.acc.count[i] = acc.count[i];
+            }
+        }
+    };
+
+    // o mutex só guarda 'terminou': a cópia e a gravação acontecem com
+    // ele livre, para o fim do render não esperar uma escrita em disco
+    std::mutex ck_mtx;
+    std::condition_variable ck_cv;
+    bool terminou = false;
+    auto intervalo = std::max(cfg.interval, std::chrono::milliseconds(1));
+    std::thread checkpointer([&] {
+        for (;;) {
+            {
+                std::unique_lock<std::mutex> lock(ck_mtx);
+                if (ck_cv.wait_for(lock, intervalo, [&] { return terminou; })) break;
+            }
+            bool mudou = false;
+            for (size_t i = 0; i < tiles.size(); ++i) {
+                if (!estado.done[i] && done[i].load(std::memory_order_acquire)) {
+                    copia_tile(tiles[i]);
+                    estado.done[i] = 1;
+                    mudou = true;
+                }
+            }
+            if (mudou && !estado.save(cfg.path))
+                std::clog << "\nfalha ao gravar checkpoint em " << cfg.path << '\n';
+        }
+    });
+
+    // faixas: tiles que faltam, contando os já terminados no checkpoint
+    int tiles_por_faixa = (width + tile_size - 1) / tile_size;
+    std::vector<std::atomic<int>> restantes(writer.band_count());
+    for (auto& r : restantes) r = tiles_por_faixa;
+
+    auto pixel = [&](int c, int l) { return acc.mean(c, l); };
+    auto tile_pronto = [&](const tile& t) {
+        int faixa = t.y0 / tile_size;
+        if (--restantes[faixa] == 0) writer.submit(faixa, pixel);
+    };
+
+    std::vector<int> pendentes;
+    for (int i = 0; i < int(tiles.size()); ++i) {
+        if (done[i]) tile_pronto(tiles[i]);
+        else pendentes.push_back(i);
+    }
+
+    pool.parallel_for(int(pendentes.size()), [&](int k) {
+        int i = pendentes[k];
+        const tile& t = tiles[i];
+        for (int l = t.y0; l < t.y1; ++l) {
+            for (int c = t.x0; c < t.x1; ++c) {
+                acc.add(c, l, shade(c, l, 0.5, 0.5));
+                for (int s = 1; s < spp; ++s) {
+                    rng g(pixel_seed(c, l, s));
+                    acc.add(c, l, shade(c, l, g.uniform(), g.uniform()));
+                }
+            }
+        }
+        done[i].store(1, std::memory_order_release);
+        tile_pronto(t);
+    });
+
+    {
+        std::lock_guard<std::mutex> lock(ck_mtx);
+        terminou = true;
+    }
+    ck_cv.notify_one();
+    checkpointer.join();
+    writer.finish();
+
+    // renderização completa: o checkpoint não serve mais
+    std::remove(cfg.path.c_str());
+    return true;
+}
+
+#endif
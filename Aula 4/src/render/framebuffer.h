@@ -0,0 +1,29 @@
+#ifndef FRAMEBUFFER_H
+#define FRAMEBUFFER_H
+
+#include "../colors/color.h"
+#include <iostream>
+#include <vector>
+
+// imagem em memória, linha a linha de cima para baixo
+class framebuffer {
+  public:
+    int width = 0;
+    int height = 0;
+    std::vector<color> pixels;
+
+    framebuffer() {}
+    framebuffer(int w, int h) : width(w), height(h), pixels(size_t(w) * h) {}
+
+    color& at(int c, int l) { return pixels[size_t(l) * width + c]; }
+    const color& at(int c, int l) const { return pixels[size_t(l) * width + c]; }
+
+    // arquivo ppm (P3), no mesmo formato do main()
+    void write_ppm(std::ostream& out) const {
+        out << "P3\n" << width << ' ' << height << "\n255\n";
+        for (const auto& p : pixels)
+            write_color(out, p);
+    }
+};
+
+#endif
@@ -0,0 +1,53 @@
+#ifndef GBUFFER_H
+#define GBUFFER_H
+
+#include "../colors/color.h"
+#include "../material/material.h"
+#include "../objects/hittable.h"
+
+#include <vector>
+
+/**
+ * atributos da interseção primária de cada pixel: normal, distância
+ * (rec.t) e albedo (k_diffuse), somados sobre as amostras do pixel
+ *
+ * pixels cujo raio primário não atingiu nada ficam com hits == 0.
+ * como no accumulator, cada pixel só é escrito pela thread do seu tile.
+ */
+class gbuffer {
+  public:
+    int width = 0;
+    int height = 0;
+
+    gbuffer(int w, int h)
+      : width(w), height(h), sum_normal(size_t(w) * h), sum_depth(size_t(w) * h, 0.0),
+        sum_albedo(size_t(w) * h), hits(size_t(w) * h, 0) {}
+
+    size_t index(int c, int l) const { return size_t(l) * width + c; }
+
+    void add(int c, int l, const hit_record& rec) {
+        if (!rec.obj) return;
+        size_t i = index(c, l);
+        sum_normal[i] += rec.normal;
+        sum_depth[i] += rec.t;
+        sum_albedo[i] += rec.mat->k_diffuse;
+        hits[i]++;
+    }
+
+    bool covered(size_t i) const { return hits[i] > 0; }
+
+    vec3 normal(size_t i) const {
+        double n = sum_normal[i].length();
+        return n > 0 ? sum_normal[i] / n : vec3(0, 0, 0);
+    }
+    double depth(size_t i) const { return hits[i] ? sum_depth[i] / hits[i] : 0.0; }
+    color albedo(size_t i) const { return hits[i] ? sum_albedo[i] / hits[i] : color(1, 1, 1); }
+
+  private:
+    std::vector<vec3> sum_normal;
+    std::vector<double> sum_depth;
+    std::vector<color> sum_albedo;
+    std::vector<int> hits;
+};
+
+#endif
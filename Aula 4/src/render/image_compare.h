@@ -0,0 +1,66 @@
+#ifndef IMAGE_COMPARE_H
+#define IMAGE_COMPARE_H
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <istream>
+#include <limits>
+#include <string>
+#include <vector>
+
+// imagem ppm lida de volta, com os valores como foram escritos
+// (write_color não limita a 255, então eles também não são limitados)
+struct ppm_image {
+    int width = 0;
+    int height = 0;
+    std::vector<int> values;  // r g b, linha a linha
+};
+
+// lê um ppm P3 (o formato de framebuffer::write_ppm); falso se não der
+inline bool read_ppm(std::istream& in, ppm_image& img) {
+    std::string magica;
+    int maximo;
+    if (!(in >> magica) || magica != "P3") return false;
+    if (!(in >> img.width >> img.height >> maximo)) return false;
+    // cabeçalho corrompido não pode pedir gigabytes
+    const int lado_max = 16384;
+    if (img.width <= 0 || img.height <= 0 || img.width > lado_max || img.height > lado_max)
+        return false;
+    if (std::int64_t(img.width) * img.height > (std::int64_t(1) << 26)) return false;
+    img.values.resize(size_t(img.width) * img.height * 3);
+    for (int& v : img.values)
+        if (!(in >> v)) return false;
+    return true;
+}
+
+struct image_diff {
+    bool same_size = false;
+    double mse = 0.0;
+    // infinito quando as imagens são iguais
+    double psnr = std::numeric_limits<double>::infinity();
+    int max_error = 0;
+    // canais diferentes
+    long long differing = 0;
+};
+
+// diferença canal a canal, com pico 255 no PSNR
+inline image_diff compare_images(const ppm_image& a, const ppm_image& b) {
+    image_diff d;
+    d.same_size = a.width == b.width && a.height == b.height;
+    if (!d.same_size) return d;
+
+    double soma = 0.0;
+    for (size_t i = 0; i < a.values.size(); ++i) {
+        int e = std::abs(a.values[i] - b.values[i]);
+        soma += double(e) * e;
+        d.max_error = std::max(d.max_error, e);
+        d.differing += e != 0;
+    }
+    d.mse = a.values.empty() ? 0.0 : soma / a.values.size();
+    if (d.mse > 0.0) d.psnr = 10.0 * std::log10(255.0 * 255.0 / d.mse);
+    return d;
+}
+
+#endif
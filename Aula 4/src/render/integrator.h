@@ -0,0 +1,156 @@
+#ifndef INTEGRATOR_H
+#define INTEGRATOR_H
+
+#include "../colors/color.h"
+#include "../material/material.h"
+#include "../objects/hittable.h"
+#include "../ray/ray.h"
+#include "../util/rng.h"
+#include "render_stats.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+
+struct integrator_settings {
+    // segmentos por caminho
+    int max_depth = 16;
+    // raios por pixel, somando todas as amostras (primários, de sombra
+    // e de continuação)
+    int ray_budget = 64;
+    // o caminho termina quando nenhum canal do peso passa disto
+    double min_throughput = 0.01;
+    // roleta russa a partir deste segmento
+    int rr_depth = 3;
+};
+
+// comprimento médio dos caminhos (segmentos por amostra), somado entre threads
+struct path_stats {
+    std::atomic<std::uint64_t> paths{0};
+    std::atomic<std::uint64_t> segments{0};
+
+    double mean_length() const { return paths ? double(segments) / double(paths) : 0.0; }
+};
+
+/**
+ * integrador iterativo de reflexão e refração (sem recursão nem pilha)
+ *
+ * em cada ponto soma o sombreamento local (Phong) vezes o peso do
+ * caminho (num vidro, só a parte que não é transmitida) e continua por um único ramo: espelho (k_reflect) ou vidro
+ * (k_transmit). no vidro, reflexão e refração são sorteadas pelo termo
+ * de Fresnel (Schlick), com o peso corrigido pela probabilidade; as
+ * amostras do pixel fazem a média dos dois ramos.
+ *
+ * o caminho termina quando: não atinge nada, o material não continua,
+ * o peso fica abaixo de min_throughput, a roleta russa descarta (com o
+ * peso dos sobreviventes compensado), passa de max_depth ou esgota
+ * 'budget' raios.
+ *
+ * hit(r, rec) traça o raio (e conta em rays_traced()); local(r, rec)
+ * devolve a cor local do ponto. 'segmentos' recebe quantos segmentos
+ * o caminho teve.
+ */
+template <class Hit, class Local>
+color trace_path(ray r, const integrator_settings& cfg, std::uint64_t budget, rng& g,
+                 int& segmentos, const Hit& hit, const Local& local) {
+    color L(0, 0, 0);
+    color peso(1, 1, 1);
+    std::uint64_t inicio = rays_traced();
+    segmentos = 0;
+
+    for (int prof = 0; prof < cfg.max_depth; ++prof) {
+        hit_record rec;
+        segmentos++;
+        if (!hit(r, rec)) break;
+
+        const material& m = *rec.mat;
+        vec3 d = unit_vector(r.direction());
+        bool frente = dot(d, rec.normal) < 0;
+        vec3 n = frente ? rec.normal : -rec.normal;
+
+        // por dentro de um objeto transparente não há luz local
+        if (frente || !m.transmissive()) {
+            rec.normal = n;
+            L += peso * (color(1, 1, 1) - m.k_transmit) * local(r, rec);
+        }
+
+        if (!m.reflective() && !m.transmissive()) break;
+        if (rays_traced() - inicio >= budget) break;
+
+        point3 origem;
+        vec3 dir;
+        if (m.transmissive()) {
+            double eta = frente ? 1.0 / m.ior : m.ior;
+            double cos_theta = std::fmin(dot(-d, n), 1.0);
+            double sin_theta = std::sqrt(std::fmax(0.0, 1.0 - cos_theta * cos_theta));
+            double r0 = (1 - eta) / (1 + eta);
+            r0 *= r0;
+            double fresnel = eta * sin_theta > 1.0 ? 1.0 : r0 + (1 - r0) * std::pow(1 - cos_theta, 5);
+
+            if (g.uniform() < fresnel) {
+                dir = reflect(d, n);
+                origem = rec.p + n * 0.001;
+                // reflexo do vidro: o sorteio já tem o peso de Fresnel
+            } else {
+                dir = refract(d, n, eta);
+                origem = rec.p - n * 0.001;
+                peso = peso * m.k_transmit;
+            }
+        } else {
+            dir = reflect(d, n);
+            origem = rec.p + n * 0.001;
+            peso = peso * m.k_reflect;
+        }
+
+        double maior = std::max({peso.x(), peso.y(), peso.z()});
+        if (maior < cfg.min_throughput) break;
+
+        if (prof + 1 >= cfg.rr_depth) {
+            double continua = std::min(1.0, maior);
+            if (g.uniform() >= continua) break;
+            peso /= continua;
+        }
+
+        r = ray(origem, dir);
+    }
+    return L;
+}
+
+/**
+ * média de spp caminhos do pixel (c, l), a primeira no centro e as
+ * demais com jitter; cada amostra recebe a sua parte do orçamento de
+ * raios que ainda resta (o que uma amostra não usa fica para as próximas)
+ *
+ * get_ray(c, l, su, sv) gera o raio primário
+ */
+template <class GetRay, class Hit, class Local>
+color integrate_pixel(int c, int l, int spp, const integrator_settings& cfg, path_stats& stats,
+                      const GetRay& get_ray, const Hit& hit, const Local& local) {
+    color soma(0, 0, 0);
+    std::uint64_t inicio = rays_traced();
+    std::uint64_t segmentos_pixel = 0;
+
+    for (int s = 0; s < spp; ++s) {
+        rng g(pixel_seed(c, l, s, 0x9a7b));
+        double su = 0.5, sv = 0.5;
+        if (s > 0) {
+            su = g.uniform();
+            sv = g.uniform();
+        }
+
+        std::uint64_t usados = rays_traced() - inicio;
+        std::uint64_t resta = usados < std::uint64_t(cfg.ray_budget) ? cfg.ray_budget - usados : 0;
+        std::uint64_t parte = std::max<std::uint64_t>(1, resta / (spp - s));
+
+        int segmentos;
+        soma += trace_path(get_ray(c, l, su, sv), cfg, parte, g, segmentos, hit, local);
+        segmentos_pixel += segmentos;
+    }
+
+    stats.paths += spp;
+    stats.segments += segmentos_pixel;
+    return soma / spp;
+}
+
+#endif
@@ -0,0 +1,162 @@
+#ifndef IRRADIANCE_CACHE_H
+#define IRRADIANCE_CACHE_H
+
+#include "../colors/color.h"
+#include "../vectors/vec3.h"
+#include "thread_pool.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+// um ponto do cache: oclusão ambiente e irradiância indireta calculadas
+// com raios no hemisfério de (p, n); r é a média harmônica das
+// distâncias atingidas (quanto mais perto os objetos, menor a validade)
+struct irradiance_record {
+    point3 p;
+    vec3 n;
+    double ao = 1.0;
+    color e;
+    double r = 0.0;
+};
+
+// como cada registro é calculado: grade x grade raios no hemisfério,
+// oclusão até 'alcance'; com 'difusa', também a luz indireta difusa
+// (um rebote) além da oclusão ambiente
+struct indirect_settings {
+    int grade = 8;
+    double alcance = 80.0;
+    bool difusa = false;
+};
+
+/**
+ * cache de irradiância (Ward) em um hash espacial
+ *
+ * um registro i vale em (p, n) com o peso
+ *
+ *   w_i = 1 / (|p - p_i| / r_i + sqrt(1 - n . n_i))
+ *
+ * e só é usado se w_i > 1 / erro; o valor em p é a média ponderada
+ * dos registros válidos. quanto menor o erro, mais registros. o raio
+ * r_i é limitado a [r_min, r_max] para não espalhar nem concentrar
+ * demais os registros.
+ *
+ * as células do hash têm lado erro * r_max: cada registro entra em
+ * todas as células que a sua esfera de validade toca.
+ *
+ * lookup() é só leitura e pode ser chamado de várias threads; add()
+ * não. populate() respeita isso: calcula em paralelo e insere em ordem.
+ */
+class irradiance_cache {
+  public:
+    indirect_settings settings;
+
+    irradiance_cache(double erro = 0.3, double r_min = 1.0, double r_max = 40.0)
+      : erro(erro), r_min(r_min), r_max(r_max), celula(erro * r_max) {}
+
+    size_t size() const { return registros.size(); }
+
+    void add(irradiance_record rec) {
+        rec.r = std::clamp(rec.r, r_min, r_max);
+        int id = int(registros.size());
+        registros.push_back(rec);
+
+        double alcance = erro * rec.r;
+        int x0 = cell(rec.p.x() - alcance), x1 = cell(rec.p.x() + alcance);
+        int y0 = cell(rec.p.y() - alcance), y1 = cell(rec.p.y() + alcance);
+        int z0 = cell(rec.p.z() - alcance), z1 = cell(rec.p.z() + alcance);
+        for (int z = z0; z <= z1; ++z)
+            for (int y = y0; y <= y1; ++y)
+                for (int x = x0; x <= x1; ++x)
+                    celulas[key(x, y, z)].push_back(id);
+    }
+
+    // interpola em (p, n); false se nenhum registro é válido ali
+    bool lookup(const point3& p, const vec3& n, double& ao, color& e) const {
+        auto it = celulas.find(key(cell(p.x()), cell(p.y()), cell(p.z())));
+        if (it == celulas.end()) return false;
+
+        double soma_w = 0.0, soma_ao = 0.0;
+        color soma_e(0, 0, 0);
+        for (int id : it->second) {
+            const irradiance_record& r = registros[id];
+            vec3 d = p - r.p;
+
+            // registro na frente do ponto: enxerga outra geometria
+            if (dot(d, 0.5 * (n + r.n)) < -0.05 * r.r) continue;
+
+            double eps = d.length() / r.r + std::sqrt(std::max(0.0, 1.0 - dot(n, r.n)));
+            if (eps >= erro) continue;
+
+            double w = 1.0 / std::max(eps, 1e-6);
+            soma_w += w;
+            soma_ao += w * r.ao;
+            soma_e += w * r.e;
+        }
+        if (soma_w == 0.0) return false;
+
+        ao = soma_ao / soma_w;
+        e = soma_e / soma_w;
+        return true;
+    }
+
+    /**
+     * preenche o cache a partir dos pontos vistos pela câmera, do grosso
+     * para o fino: pixels a cada 8, 4, 2 e 1. em cada nível, só os
+     * pontos que o cache ainda não cobre ganham um registro novo.
+     *
+     * primary(c, l, p, n) devolve false se o pixel não atinge nada;
+     * compute(p, n) calcula o registro. o resultado não depende da
+     * quantidade de threads. devolve quantos registros foram calculados.
+     */
+    template <class Primary, class Compute>
+    size_t populate(thread_pool& pool, int width, int height, const Primary& primary,
+                    const Compute& compute, int passo_inicial = 8) {
+        size_t calculados = 0;
+        for (int passo = passo_inicial; passo >= 1; passo /= 2) {
+            int colunas = (width + passo - 1) / passo;
+            int linhas = (height + passo - 1) / passo;
+
+            // pontos descobertos, em ordem de pixel
+            std::vector<std::vector<std::pair<point3, vec3>>> faltam(linhas);
+            pool.parallel_for(linhas, [&](int i) {
+                for (int j = 0; j < colunas; ++j) {
+                    point3 p;
+                    vec3 n;
+                    double ao;
+                    color e;
+                    if (primary(j * passo, i * passo, p, n) && !lookup(p, n, ao, e))
+                        faltam[i].push_back({p, n});
+                }
+            });
+
+            std::vector<std::pair<point3, vec3>> pontos;
+            for (auto& f : faltam) pontos.insert(pontos.end(), f.begin(), f.end());
+
+            std::vector<irradiance_record> novos(pontos.size());
+            pool.parallel_for(int(pontos.size()), [&](int i) {
+                novos[i] = compute(pontos[i].first, pontos[i].second);
+            });
+            for (const auto& r : novos) add(r);
+            calculados += novos.size();
+        }
+        return calculados;
+    }
+
+  private:
+    double erro, r_min, r_max, celula;
+    std::vector<irradiance_record> registros;
+    std::unordered_map<std::uint64_t, std::vector<int>> celulas;
+
+    int cell(double x) const { return int(std::floor(x / celula)); }
+
+    static std::uint64_t key(int x, int y, int z) {
+        return (std::uint64_t(std::uint32_t(x) & 0x1fffff) << 42) |
+               (std::uint64_t(std::uint32_t(y) & 0x1fffff) << 21) |
+               std::uint64_t(std::uint32_t(z) & 0x1fffff);
+    }
+};
+
+#endif
@@ -0,0 +1,211 @@
+#ifndef NUMA_H
+#define NUMA_H
+
+#include "framebuffer.h"
+#include "render_stats.h"
+#include "renderer.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <exception>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+// um nó NUMA e os núcleos que pertencem a ele
+struct numa_node {
+    int id = 0;
+    std::vector<int> cpus;
+};
+
+// lê uma lista no formato do kernel: "0-3,8,10-11"
+inline std::vector<int> parse_cpulist(const std::string& texto) {
+    std::vector<int> cpus;
+    std::stringstream ss(texto);
+    std::string faixa;
+    while (std::getline(ss, faixa, ',')) {
+        if (faixa.empty() || faixa == "\n") continue;
+        size_t traco = faixa.find('-');
+        int a = std::stoi(faixa.substr(0, traco));
+        int b = traco == std::string::npos ? a : std::stoi(faixa.substr(traco + 1));
+        for (int c = a; c <= b; ++c) cpus.push_back(c);
+    }
+    return cpus;
+}
+
+// topologia da máquina; sem informação do sistema, um nó só com
+// todas as cpus
+inline std::vector<numa_node> numa_topology() {
+    std::vector<numa_node> nos;
+#ifdef __linux__
+    std::ifstream online("/sys/devices/system/node/online");
+    std::string ids;
+    if (std::getline(online, ids)) {
+        for (int id : parse_cpulist(ids)) {
+            std::ifstream f("/sys/devices/system/node/node" + std::to_string(id) + "/cpulist");
+            std::string lista;
+            if (!std::getline(f, lista)) continue;
+            numa_node no;
+            no.id = id;
+            no.cpus = parse_cpulist(lista);
+            if (!no.cpus.empty()) nos.push_back(no);
+        }
+    }
+#endif
+    if (nos.empty()) {
+        numa_node no;
+        int n = std::max(1u, std::thread::hardware_concurrency());
+        for (int c = 0; c < n; ++c) no.cpus.push_back(c);
+        nos.push_back(no);
+    }
+    return nos;
+}
+
+// fixa a thread atual em um conjunto de cpus (sem efeito fora do linux);
+// threads criadas depois por ela herdam o conjunto
+inline bool pin_current_thread(const std::vector<int>& cpus) {
+#ifdef __linux__
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    for (int cpu : cpus) CPU_SET(cpu, &set);
+    return pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+#else
+    (void)cpus;
+    return false;
+#endif
+}
+
+// fixa a thread atual em uma cpu
+inline bool pin_current_thread(int cpu) { return pin_current_thread(std::vector<int>{cpu}); }
+
+struct numa_node_stats {
+    int node = 0;
+    int threads = 0;
+    int tiles = 0;
+    int stolen = 0;
+    std::uint64_t rays = 0;
+    double busy_ms = 0.0;
+};
+
+/**
+ * renderização ciente de NUMA
+ *
+ * - cada nó recebe a sua própria cópia do cenário, construída por
+ *   make_scene(threads) em uma thread fixada nas cpus do nó: pela
+ *   política de "first touch" as páginas ficam na memória local do nó.
+ *   'threads' é quantas threads o nó vai usar; as que make_scene criar
+ *   (um pool para pré-calcular algo, p.ex.) também ficam no nó;
+ * - uma thread por cpu, fixada no seu núcleo, lendo só a cópia do
+ *   seu nó;
+ * - os tiles são divididos em faixas contíguas, uma por nó. cada nó
+ *   consome a sua fila e só depois rouba tiles da fila de outro nó.
+ *
+ * make_scene(threads) devolve um shared_ptr para o cenário (qualquer
+ * tipo); uma exceção dela sai de numa_render antes do render.
+ * shade(cena, c, l) devolve a cor do pixel.
+ */
+template <class MakeScene, class Shade>
+std::vector<numa_node_stats> numa_render(framebuffer& fb, int tile_size, int threads_por_no,
+                                         const MakeScene& make_scene, const Shade& shade) {
+    using clock = std::chrono::steady_clock;
+    auto nos = numa_topology();
+    auto tiles = make_tiles(fb.width, fb.height, tile_size);
+    int n_nos = int(nos.size());
+
+    // threads de cada nó
+    std::vector<int> n_threads(n_nos);
+    for (int k = 0; k < n_nos; ++k)
+        n_threads[k] = threads_por_no > 0 ? std::min<int>(threads_por_no, int(nos[k].cpus.size()))
+                                          : int(nos[k].cpus.size());
+
+    // réplicas do cenário, cada uma construída no seu nó
+    using scene_ptr = decltype(make_scene(1));
+    std::vector<scene_ptr> cenas(n_nos);
+    {
+        std::vector<std::thread> construtores;
+        std::vector<std::exception_ptr> erros(n_nos);
+        for (int k = 0; k < n_nos; ++k) {
+            construtores.emplace_back([&, k] {
+                pin_current_thread(nos[k].cpus);
+                try {
+                    cenas[k] = make_scene(n_threads[k]);
+                } catch (...) {
+                    erros[k] = std::current_exception();
+                }
+            });
+        }
+        for (auto& t : construtores) t.join();
+        for (auto& e : erros)
+            if (e) std::rethrow_exception(e);
+    }
+
+    // fila de cada nó: faixa contígua [inicio, fim) dos tiles
+    struct fila {
+        std::atomic<int> next{0};
+        int fim = 0;
+    };
+    std::vector<fila> filas(n_nos);
+    for (int k = 0; k < n_nos; ++k) {
+        filas[k].next = int(tiles.size() * k / n_nos);
+        filas[k].fim = int(tiles.size() * (k + 1) / n_nos);
+    }
+
+    std::vector<numa_node_stats> stats(n_nos);
+    std::vector<std::thread> threads;
+    std::vector<std::vector<numa_node_stats>> locais(n_nos);
+
+    for (int k = 0; k < n_nos; ++k) {
+        int n = n_threads[k];
+        stats[k].node = nos[k].id;
+        stats[k].threads = n;
+        locais[k].resize(n);
+
+        for (int i = 0; i < n; ++i) {
+            threads.emplace_back([&, k, i] {
+                pin_current_thread(nos[k].cpus[i]);
+                const auto& cena = *cenas[k];
+                numa_node_stats& st = locais[k][i];
+                auto inicio = clock::now();
+
+                for (int d = 0; d < n_nos; ++d) {
+                    fila& f = filas[(k + d) % n_nos];
+                    for (int t = f.next++; t < f.fim; t = f.next++) {
+                        const tile& tl = tiles[t];
+                        std::uint64_t antes = rays_traced();
+                        for (int l = tl.y0; l < tl.y1; ++l)
+                            for (int c = tl.x0; c < tl.x1; ++c)
+                                fb.at(c, l) = shade(cena, c, l);
+                        st.rays += rays_traced() - antes;
+                        st.tiles++;
+                        if (d > 0) st.stolen++;
+                    }
+                }
+                st.busy_ms = std::chrono::duration<double, std::milli>(clock::now() - inicio).count();
+            });
+        }
+    }
+    for (auto& t : threads) t.join();
+
+    for (int k = 0; k < n_nos; ++k) {
+        for (const auto& st : locais[k]) {
+            stats[k].tiles += st.tiles;
+            stats[k].stolen += st.stolen;
+            stats[k].rays += st.rays;
+            stats[k].busy_ms = std::max(stats[k].busy_ms, st.busy_ms);
+        }
+    }
+    return stats;
+}
+
+#endif
@@ -0,0 +1,305 @@
+#ifndef PATH_TRACER_H
+#define PATH_TRACER_H
+
+#include "../colors/color.h"
+#include "../lights/light.h"
+#include "../material/material.h"
+#include "../sampling/sampler.h"
+#include "../scene/scene.h"
+#include "accumulator.h"
+#include "gbuffer.h"
+#include "render_stats.h"
+#include "renderer.h"
+#include "thread_pool.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+
+struct path_settings {
+    int max_depth = 8;
+    // roleta russa a partir deste segmento
+    int rr_depth = 3;
+    // a intensidade das luzes é a do Phong (sem queda com a distância);
+    // multiplicada por isto vira intensidade radiante (W/sr), o que dá
+    // o mesmo brilho do Phong a ~70 unidades da luz
+    double light_scale = 1.6e4;
+    // false: path tracing ingênuo, só a amostragem da BSDF (para comparar)
+    bool nee = true;
+};
+
+/**
+ * path tracer Monte Carlo sobre o mesmo cenário do Phong
+ *
+ * BSDF derivada do material: lambertiana (k_diffuse), brilhante com
+ * Phong normalizado (k_specular, shininess), espelho (k_reflect) e
+ * vidro com Fresnel (k_transmit, ior). se a soma das refletâncias
+ * passar de 1, todas são reduzidas na mesma proporção (conserva energia).
+ * não há termo ambiente: a luz indireta vem dos próprios caminhos.
+ *
+ * em cada vértice não especular, cada luz recebe uma amostra direta
+ * (next-event estimation) testada contra os oclusores dela. as luzes
+ * de área também podem ser atingidas pelos raios da BSDF; as duas
+ * estratégias são combinadas com a heurística da potência (MIS).
+ * luzes pontuais só são alcançadas pela amostra direta.
+ *
+ * as dimensões aleatórias vêm do amostrador: 0 para a posição no pixel
+ * e, por segmento, uma para a direção, uma para lóbulo/roleta e uma
+ * por luz.
+ */
+class path_tracer {
+  public:
+    path_tracer(const scene& cena, const sampler& amostrador, const path_settings& cfg)
+      : cena(cena), amostrador(amostrador), cfg(cfg) {}
+
+    // se 'primario' não for nulo, recebe a interseção do raio primário
+    // (obj nulo se não atingiu nada ou atingiu uma luz)
+    color trace(ray r, int c, int l, int amostra, hit_record* primario = nullptr) const {
+        const double tmin = 0.001;
+        const double inf = std::numeric_limits<double>::infinity();
+        const int nl = int(cena.lights.size());
+
+        color L(0, 0, 0);
+        color peso(1, 1, 1);
+        // o último desvio foi especular (ou é o raio primário): emissão sem MIS
+        bool especular = true;
+        double pdf_bsdf = 0.0;
+
+        for (int prof = 0; prof < cfg.max_depth; ++prof) {
+            const int dim = 1 + prof * (2 + nl);
+            r = ray(r.origin(), unit_vector(r.direction()));
+
+            hit_record rec;
+            rays_traced()++;
+            bool atingiu = cena.world->hit(r, tmin, inf, rec);
+
+            // luz de área na frente do objeto (ou no lugar do fundo)
+            double t_luz = atingiu ? rec.t : inf;
+            const light* luz_atingida = nullptr;
+            vec3 n_luz;
+            for (const light& luz : cena.lights) {
+                double t;
+                vec3 n;
+                if (luz.is_area() && luz.intersect(r, tmin, t_luz, t, n)) {
+                    t_luz = t;
+                    n_luz = n;
+                    luz_atingida = &luz;
+                }
+            }
+            if (primario && prof == 0 && !luz_atingida) *primario = rec;
+            if (luz_atingida) {
+                double w = 1.0;
+                if (!especular && cfg.nee) {
+                    double pdf_luz = t_luz * t_luz / (luz_atingida->area() * -dot(n_luz, r.direction()));
+                    w = potencia(pdf_bsdf, pdf_luz);
+                }
+                L += w * peso * radiancia(*luz_atingida);
+                break;
+            }
+            if (!atingiu) break;
+
+            const material& m = *rec.mat;
+            vec3 wo = -r.direction();
+            bool frente = dot(wo, rec.normal) > 0;
+            vec3 n = frente ? rec.normal : -rec.normal;
+
+            // refletâncias e probabilidades dos lóbulos
+            color kd = m.k_diffuse, ks = m.k_specular, kr = m.k_reflect, kt = m.k_transmit;
+            if (!frente && m.transmissive()) kd = ks = kr = color(0, 0, 0);
+            double pd = luminance(kd), ps = luminance(ks), pr = luminance(kr), pt = luminance(kt);
+            double soma = pd + ps + pr + pt;
+            if (soma <= 0.0) break;
+            if (soma > 1.0) {
+                kd /= soma; ks /= soma; kr /= soma; kt /= soma;
+            }
+            pd /= soma; ps /= soma; pr /= soma; pt /= soma;
+            bsdf f{kd, ks, double(m.shininess), pd, ps, n, wo};
+
+            // amostra direta de cada luz
+            point3 origem = rec.p + n * tmin;
+            if (cfg.nee && pd + ps > 0.0) {
+                for (int k = 0; k < nl; ++k) {
+                    const light& luz = cena.lights[k];
+                    double su, sv;
+                    amostrador.get_2d(c, l, amostra, dim + 2 + k, su, sv);
+                    L += peso * direta(luz, f, rec.p, origem, su, sv);
+                }
+            }
+
+            // próxima direção
+            double u, v, u_lobo, u_rr;
+            amostrador.get_2d(c, l, amostra, dim, u, v);
+            amostrador.get_2d(c, l, amostra, dim + 1, u_lobo, u_rr);
+
+            vec3 wi;
+            if (u_lobo < pd + ps) {
+                wi = u_lobo < pd ? cosseno(n, u, v) : f.sample_glossy(u, v);
+                double cos_i = dot(wi, n);
+                if (cos_i <= 0.0) break;
+                pdf_bsdf = f.pdf(wi);
+                if (pdf_bsdf <= 0.0) break;
+                peso = peso * f.eval(wi) * (cos_i / pdf_bsdf);
+                especular = false;
+            } else if (u_lobo < pd + ps + pr) {
+                wi = reflect(-wo, n);
+                peso = peso * kr / pr;
+                especular = true;
+            } else {
+                // vidro: reflexão ou refração sorteada pelo Fresnel
+                double eta = frente ? 1.0 / m.ior : m.ior;
+                double cos_theta = std::fmin(dot(wo, n), 1.0);
+                double sin_theta = std::sqrt(std::fmax(0.0, 1.0 - cos_theta * cos_theta));
+                double r0 = (1 - eta) / (1 + eta);
+                r0 *= r0;
+                double fresnel = eta * sin_theta > 1.0 ? 1.0 : r0 + (1 - r0) * std::pow(1 - cos_theta, 5);
+                if (u < fresnel) {
+                    wi = reflect(-wo, n);
+                } else {
+                    wi = refract(-wo, n, eta);
+                    origem = rec.p - n * tmin;
+                }
+                peso = peso * kt / pt;
+                especular = true;
+            }
+
+            if (prof + 1 >= cfg.rr_depth) {
+                double continua = std::min(1.0, std::max({peso.x(), peso.y(), peso.z()}));
+                if (u_rr >= continua) break;
+                peso /= continua;
+            }
+
+            r = ray(origem, wi);
+        }
+        return L;
+    }
+
+  private:
+    const scene& cena;
+    const sampler& amostrador;
+    path_settings cfg;
+
+    static constexpr double pi = 3.1415926535897932385;
+
+    // parte contínua da BSDF (lambertiana + Phong normalizado)
+    struct bsdf {
+        color kd, ks;
+        double e;
+        double pd, ps;
+        vec3 n, wo;
+
+        color eval(const vec3& wi) const {
+            color f = kd / pi;
+            if (ps > 0.0) {
+                double cos_a = dot(reflect(-wo, n), wi);
+                if (cos_a > 0.0) f += ks * ((e + 2) / (2 * pi) * pow_lobo(cos_a, e));
+            }
+            return f;
+        }
+
+        // densidade da mistura dos dois lóbulos (em ângulo sólido)
+        double pdf(const vec3& wi) const {
+            double p = pd * std::max(0.0, dot(wi, n)) / pi;
+            if (ps > 0.0) {
+                double cos_a = dot(reflect(-wo, n), wi);
+                if (cos_a > 0.0) p += ps * (e + 1) / (2 * pi) * pow_lobo(cos_a, e);
+            }
+            return p;
+        }
+
+        vec3 sample_glossy(double u, double v) const {
+            vec3 eixo = reflect(-wo, n);
+            double cos_a = pow_lobo(u, 1.0 / (e + 1));
+            double sin_a = std::sqrt(std::fmax(0.0, 1 - cos_a * cos_a));
+            vec3 t1, t2;
+            base(eixo, t1, t2);
+            return sin_a * std::cos(2 * pi * v) * t1 + sin_a * std::sin(2 * pi * v) * t2 + cos_a * eixo;
+        }
+    };
+
+    // pow dos lóbulos especulares: fast_pow no modo rápido
+    static double pow_lobo(double x, double e) {
+        if constexpr (fast_math) return fast_pow(x, e);
+        return std::pow(x, e);
+    }
+
+    static void base(const vec3& n, vec3& t1, vec3& t2) {
+        vec3 a = std::fabs(n.x()) > 0.9 ? vec3(0, 1, 0) : vec3(1, 0, 0);
+        t1 = unit_vector(cross(a, n));
+        t2 = cross(n, t1);
+    }
+
+    static vec3 cosseno(const vec3& n, double u, double v) {
+        vec3 t1, t2;
+        base(n, t1, t2);
+        double r = std::sqrt(u), phi = 2 * pi * v;
+        return r * std::cos(phi) * t1 + r * std::sin(phi) * t2 + std::sqrt(std::fmax(0.0, 1 - u)) * n;
+    }
+
+    static double potencia(double a, double b) {
+        return a * a / (a * a + b * b);
+    }
+
+    // radiância emitida por uma luz de área (mesma potência da pontual)
+    color radiancia(const light& luz) const {
+        double a = luz.kind == light::shape::sphere ? pi * luz.radius * luz.radius : luz.area();
+        return luz.intensity * (cfg.light_scale / a);
+    }
+
+    color direta(const light& luz, const bsdf& f, const point3& p, const point3& origem,
+                 double su, double sv) const {
+        vec3 n_luz;
+        point3 q = luz.is_area() ? luz.sample_surface(su, sv, n_luz) : luz.position;
+        vec3 d = q - p;
+        double dist = d.length();
+        vec3 wi = d / dist;
+        double cos_i = dot(wi, f.n);
+        if (cos_i <= 0.0) return color(0, 0, 0);
+
+        double cos_luz = luz.is_area() ? -dot(n_luz, wi) : 1.0;
+        if (cos_luz <= 0.0) return color(0, 0, 0);
+
+        rays_traced()++;
+        if (luz.occluders->hit_any(ray(origem, wi), 0.001, dist - 0.001)) return color(0, 0, 0);
+
+        if (!luz.is_area())
+            return f.eval(wi) * luz.intensity * (cfg.light_scale * cos_i / (dist * dist));
+
+        double pdf_luz = dist * dist / (luz.area() * cos_luz);
+        double w = potencia(pdf_luz, f.pdf(wi));
+        return f.eval(wi) * radiancia(luz) * (w * cos_i / pdf_luz);
+    }
+};
+
+/**
+ * acumulação progressiva: 'passadas' passadas de 1 amostra por pixel
+ * sobre os tiles; on_pass(acc, passada) recebe a média até ali
+ *
+ * shade(c, l, amostra, rec) devolve uma amostra do pixel e preenche rec
+ * com a interseção primária, que vai para o g-buffer
+ */
+template <class Shade, class OnPass>
+std::uint64_t render_accumulate(thread_pool& pool, accumulator& acc, gbuffer& g, int tile_size, int passadas,
+                                const Shade& shade, const OnPass& on_pass) {
+    auto tiles = make_tiles(acc.width, acc.height, tile_size);
+    std::atomic<std::uint64_t> raios{0};
+
+    for (int passada = 1; passada <= passadas; ++passada) {
+        pool.parallel_for(int(tiles.size()), [&](int i) {
+            const tile& t = tiles[i];
+            std::uint64_t antes = rays_traced();
+            for (int l = t.y0; l < t.y1; ++l)
+                for (int c = t.x0; c < t.x1; ++c) {
+                    hit_record rec;
+                    acc.add(c, l, shade(c, l, acc.samples(c, l), rec));
+                    g.add(c, l, rec);
+                }
+            raios += rays_traced() - antes;
+        });
+        on_pass(acc, passada);
+    }
+    return raios;
+}
+
+#endif
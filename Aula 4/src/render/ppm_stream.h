@@ -0,0 +1,106 @@
+#ifndef PPM_STREAM_H
+#define PPM_STREAM_H
+
+#include "../colors/color.h"
+#include "framebuffer.h"
+
+#include <algorithm>
+#include <condition_variable>
+#include <functional>
+#include <iostream>
+#include <mutex>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+/**
+ * escreve um ppm (P3) em ordem enquanto as faixas de linhas ficam
+ * prontas fora de ordem
+ *
+ * o cabeçalho sai assim que o escritor é criado. cada faixa entregue
+ * por submit() espera no buffer de reordenação até todas as anteriores
+ * terem sido escritas. a escrita roda em uma thread de E/S própria,
+ * então a saída sobrepõe o cálculo.
+ */
+class ppm_stream_writer {
+  public:
+    // chamada na thread de E/S depois de cada faixa escrita
+    std::function<void(int faixas_escritas, int total)> on_band_written;
+
+    ppm_stream_writer(std::ostream& out, int width, int height, int band_height)
+      : out(out), width(width), height(height), band_height(band_height),
+        n_bands(bandas(height, band_height)),
+        slots(n_bands), ready(n_bands, false) {
+        out << "P3\n" << width << ' ' << height << "\n255\n" << std::flush;
+        io = std::thread([this] { run(); });
+    }
+
+    ~ppm_stream_writer() { finish(); }
+
+    int band_count() const { return n_bands; }
+
+    // formata as linhas da faixa (na thread que chamou) e entrega ao buffer
+    void submit(int band, const framebuffer& fb) {
+        submit(band, [&](int c, int l) { return fb.at(c, l); });
+    }
+
+    // idem, lendo cada pixel de pixel(c, l)
+    template <class Pixel>
+    void submit(int band, const Pixel& pixel) {
+        std::ostringstream ss;
+        int l0 = band * band_height;
+        int l1 = std::min(l0 + band_height, height);
+        for (int l = l0; l < l1; ++l)
+            for (int c = 0; c < width; ++c)
+                write_color(ss, pixel(c, l));
+
+        {
+            std::lock_guard<std::mutex> lock(mtx);
+            slots[band] = ss.str();
+            ready[band] = true;
+        }
+        cv.notify_one();
+    }
+
+    // espera todas as faixas serem escritas
+    void finish() {
+        if (io.joinable()) io.join();
+    }
+
+  private:
+    std::ostream& out;
+    int width;
+    int height;
+    int band_height;
+    int n_bands;
+
+    // buffer de reordenação
+    std::vector<std::string> slots;
+    std::vector<bool> ready;
+    std::mutex mtx;
+    std::condition_variable cv;
+    std::thread io;
+
+    static int bandas(int height, int band_height) {
+        if (band_height < 1) throw std::invalid_argument("ppm_stream_writer: altura de faixa menor que 1");
+        return (height + band_height - 1) / band_height;
+    }
+
+    void run() {
+        for (int next = 0; next < n_bands; ++next) {
+            std::string dados;
+            {
+                std::unique_lock<std::mutex> lock(mtx);
+                cv.wait(lock, [&] { return ready[next]; });
+                dados.swap(slots[next]);
+            }
+            out.write(dados.data(), std::streamsize(dados.size()));
+            out.flush();
+            if (on_band_written) on_band_written(next + 1, n_bands);
+        }
+    }
+};
+
+#endif
@@ -0,0 +1,64 @@
+#ifndef PROGRESSIVE_H
+#define PROGRESSIVE_H
+
+#include "framebuffer.h"
+#include "render_stats.h"
+#include "thread_pool.h"
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+
+/**
+ * renderização progressiva em várias resoluções
+ *
+ * a primeira passada calcula um pixel a cada 8x8 (1/8 da resolução),
+ * as seguintes 1/4, 1/2 e a resolução cheia. cada passada só calcula
+ * os pixels novos da sua grade: os das grades anteriores já são
+ * amostras finais (centro do pixel) e são reaproveitados, então o
+ * custo total é o de uma renderização normal.
+ *
+ * depois de cada passada, a prévia em resolução cheia é montada
+ * repetindo cada amostra no seu bloco (vizinho mais próximo) e
+ * entregue a on_pass(previa, passo).
+ */
+template <class Shade>
+std::uint64_t render_progressive(thread_pool& pool, int width, int height, const Shade& shade,
+                                 const std::function<void(const framebuffer&, int)>& on_pass,
+                                 int passo_inicial = 8) {
+    framebuffer amostras(width, height);
+    framebuffer previa(width, height);
+    std::atomic<std::uint64_t> raios{0};
+
+    for (int passo = passo_inicial; passo >= 1; passo /= 2) {
+        bool primeira = passo == passo_inicial;
+        int linhas = (height + passo - 1) / passo;
+
+        // pixels novos: na grade do passo, fora da grade da passada anterior
+        pool.parallel_for(linhas, [&](int i) {
+            int l = i * passo;
+            std::uint64_t antes = rays_traced();
+            for (int c = 0; c < width; c += passo) {
+                bool ja_calculado = !primeira && (l % (2*passo) == 0) && (c % (2*passo) == 0);
+                if (!ja_calculado) amostras.at(c, l) = shade(c, l);
+            }
+            raios += rays_traced() - antes;
+        });
+
+        if (passo == 1) {
+            on_pass(amostras, 1);
+            break;
+        }
+
+        pool.parallel_for(height, [&](int l) {
+            int la = l - l % passo;
+            for (int c = 0; c < width; ++c)
+                previa.at(c, l) = amostras.at(c - c % passo, la);
+        });
+        on_pass(previa, passo);
+    }
+
+    return raios;
+}
+
+#endif
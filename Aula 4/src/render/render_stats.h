@@ -0,0 +1,14 @@
+#ifndef RENDER_STATS_H
+#define RENDER_STATS_H
+
+#include <cstdint>
+
+// contador de raios disparados pela thread atual
+// cada thread conta no seu próprio contador, sem disputa;
+// o renderizador soma as diferenças ao fim de cada tile
+inline std::uint64_t& rays_traced() {
+    static thread_local std::uint64_t count = 0;
+    return count;
+}
+
+#endif
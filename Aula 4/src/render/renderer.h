@@ -0,0 +1,128 @@
+#ifndef RENDERER_H
+#define RENDERER_H
+
+#include "framebuffer.h"
+#include "ppm_stream.h"
+#include "render_stats.h"
+#include "thread_pool.h"
+#include "../sampling/sampler.h"
+#include "../util/rng.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <stdexcept>
+#include <vector>
+
+// retângulo de pixels [x0, x1) x [y0, y1)
+struct tile {
+    int x0, y0, x1, y1;
+};
+
+// divide a imagem em tiles de 'size' x 'size', linha a linha
+inline std::vector<tile> make_tiles(int width, int height, int size) {
+    if (size < 1) throw std::invalid_argument("make_tiles: tamanho de tile menor que 1");
+    std::vector<tile> tiles;
+    for (int y = 0; y < height; y += size)
+        for (int x = 0; x < width; x += size)
+            tiles.push_back({x, y, std::min(x + size, width), std::min(y + size, height)});
+    return tiles;
+}
+
+// média de 'spp' amostras do pixel (c, l): a primeira no centro,
+// as demais com jitter reprodutível; shade(c, l, su, sv) devolve uma amostra
+template <class Shade>
+color sample_pixel(int c, int l, int spp, const Shade& shade) {
+    color soma = shade(c, l, 0.5, 0.5);
+    for (int s = 1; s < spp; ++s) {
+        rng g(pixel_seed(c, l, s));
+        soma += shade(c, l, g.uniform(), g.uniform());
+    }
+    return soma / spp;
+}
+
+// o mesmo com as posições dentro do pixel vindas de um amostrador
+// (dimensão 0); o spp é o do amostrador. as posições são geradas em
+// lotes de até 64 com fill_2d
+template <class Shade>
+color sample_pixel(int c, int l, const sampler& amostrador, const Shade& shade) {
+    const int lote = 64;
+    int spp = amostrador.samples_per_pixel();
+    double uv[2 * lote];
+    color soma(0, 0, 0);
+    for (int s0 = 0; s0 < spp; s0 += lote) {
+        int n = std::min(lote, spp - s0);
+        amostrador.fill_2d(c, l, 0, s0, n, uv);
+        for (int k = 0; k < n; ++k) soma += shade(c, l, uv[2 * k], uv[2 * k + 1]);
+    }
+    return soma / spp;
+}
+
+/**
+ * renderiza a imagem em paralelo, um tile por tarefa
+ * shade(c, l) devolve a cor do pixel (c, l)
+ * devolve o total de raios disparados
+ */
+template <class Shade>
+std::uint64_t render_tiles(thread_pool& pool, framebuffer& fb, int tile_size, const Shade& shade) {
+    auto tiles = make_tiles(fb.width, fb.height, tile_size);
+    std::atomic<std::uint64_t> raios{0};
+
+    pool.parallel_for(int(tiles.size()), [&](int i) {
+        const tile& t = tiles[i];
+        std::uint64_t antes = rays_traced();
+        for (int l = t.y0; l < t.y1; ++l)
+            for (int c = t.x0; c < t.x1; ++c)
+                fb.at(c, l) = shade(c, l);
+        raios += rays_traced() - antes;
+    });
+
+    return raios;
+}
+
+/**
+ * igual a render_tiles, mas entrega cada faixa de tiles ao escritor
+ * assim que o último tile dela termina. a faixa tem a altura de um tile;
+ * o escritor deve ter sido criado com band_height == tile_size.
+ * shade_tile(t) preenche em fb todos os pixels do tile t (para quem
+ * processa o tile em lote)
+ */
+template <class ShadeTile>
+std::uint64_t render_tile_batches_streaming(thread_pool& pool, framebuffer& fb, int tile_size,
+                                            ppm_stream_writer& writer, const ShadeTile& shade_tile) {
+    auto tiles = make_tiles(fb.width, fb.height, tile_size);
+    int tiles_por_faixa = (fb.width + tile_size - 1) / tile_size;
+
+    std::vector<std::atomic<int>> restantes(writer.band_count());
+    for (auto& r : restantes) r = tiles_por_faixa;
+
+    std::atomic<std::uint64_t> raios{0};
+
+    pool.parallel_for(int(tiles.size()), [&](int i) {
+        const tile& t = tiles[i];
+        std::uint64_t antes = rays_traced();
+        shade_tile(t);
+        raios += rays_traced() - antes;
+
+        // quem termina o último tile da faixa a entrega
+        int faixa = t.y0 / tile_size;
+        if (--restantes[faixa] == 0)
+            writer.submit(faixa, fb);
+    });
+
+    writer.finish();
+    return raios;
+}
+
+// o mesmo, pixel a pixel: shade(c, l) devolve a cor do pixel (c, l)
+template <class Shade>
+std::uint64_t render_tiles_streaming(thread_pool& pool, framebuffer& fb, int tile_size,
+                                     ppm_stream_writer& writer, const Shade& shade) {
+    return render_tile_batches_streaming(pool, fb, tile_size, writer, [&](const tile& t) {
+        for (int l = t.y0; l < t.y1; ++l)
+            for (int c = t.x0; c < t.x1; ++c)
+                fb.at(c, l) = shade(c, l);
+    });
+}
+
+#endif
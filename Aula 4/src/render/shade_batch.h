@@ -0,0 +1,447 @@
+#ifndef SHADE_BATCH_H
+#define SHADE_BATCH_H
+
+#include "../colors/color.h"
+#include "../util/fast_math.h"
+#include "../vectors/vec3.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include <immintrin.h>
+#define SHADE_BATCH_X86 1
+#endif
+
+/**
+ * Phong em lote, com os pontos atingidos em estrutura de arrays (SoA)
+ *
+ * o traçado (raios primários e de sombra) continua escalar: ele só
+ * preenche o lote, e a visibilidade de cada luz entra como peso 0/1.
+ * o sombreamento de luzes pontuais corre então 8 (AVX2) ou 16
+ * (AVX-512) pontos por vez, em float, com um pow aproximado
+ * (fast_pow). o caminho escalar faz as mesmas contas, uma de cada vez.
+ *
+ * shade_batch_reference faz o mesmo em double com std::pow; serve de
+ * referência para o erro e de base para medir o ganho.
+ */
+
+// conjunto de instruções usado pelo sombreamento em lote
+enum class simd_isa { scalar, avx2, avx512 };
+
+inline const char* simd_name(simd_isa isa) {
+    switch (isa) {
+        case simd_isa::avx2:   return "avx2";
+        case simd_isa::avx512: return "avx512";
+        default:               return "escalar";
+    }
+}
+
+inline bool simd_supported(simd_isa isa) {
+#ifdef SHADE_BATCH_X86
+    if (isa == simd_isa::avx512) return __builtin_cpu_supports("avx512f");
+    if (isa == simd_isa::avx2) return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+#endif
+    return isa == simd_isa::scalar;
+}
+
+// o melhor disponível nesta máquina
+inline simd_isa simd_best() {
+    if (simd_supported(simd_isa::avx512)) return simd_isa::avx512;
+    if (simd_supported(simd_isa::avx2)) return simd_isa::avx2;
+    return simd_isa::scalar;
+}
+
+// "auto", "escalar", "avx2" ou "avx512"
+inline simd_isa simd_parse(const std::string& nome) {
+    if (nome == "escalar") return simd_isa::scalar;
+    if (nome == "avx2") return simd_isa::avx2;
+    if (nome == "avx512") return simd_isa::avx512;
+    return simd_best();
+}
+
+// luz pontual do lote
+struct batch_light {
+    float x, y, z;
+    float r, g, b;
+};
+
+/**
+ * lote de pontos atingidos: um array por componente
+ *
+ * d* é a direção do raio (não precisa ser unitária); os
+ * coeficientes do material vão copiados em cada ponto, para que o
+ * núcleo vetorial só faça leituras contíguas. vis[k * capacity() + i]
+ * é 1 se a luz k ilumina o ponto i. o tamanho é arredondado para um
+ * múltiplo de 16 com pontos neutros (cor 0).
+ */
+class hit_batch {
+  public:
+    static constexpr int lanes = 16;
+
+    std::vector<float> px, py, pz;
+    std::vector<float> nx, ny, nz;
+    std::vector<float> dx, dy, dz;
+    std::vector<float> ka_r, ka_g, ka_b;
+    std::vector<float> kd_r, kd_g, kd_b;
+    std::vector<float> ks_r, ks_g, ks_b;
+    std::vector<float> shininess;
+    std::vector<float> vis;
+    // índice do pixel de cada ponto (quem chamou decide o significado)
+    std::vector<int> pixel;
+
+    hit_batch(int luzes = 1) : luzes(luzes) {}
+
+    int size() const { return n; }
+    int capacity() const { return int(px.size()); }
+    int light_count() const { return luzes; }
+
+    void clear(int num_luzes) {
+        n = 0;
+        luzes = num_luzes;
+        pixel.clear();
+        std::fill(vis.begin(), vis.end(), 0.0f);
+        vis.resize(size_t(luzes) * capacity(), 0.0f);
+    }
+
+    // acrescenta um ponto; devolve o seu índice (para preencher vis)
+    int add(int pix, const point3& p, const vec3& normal, const vec3& dir,
+            const color& ka, const color& kd, const color& ks, int m) {
+        if (n == capacity()) grow();
+        int i = n++;
+        px[i] = float(p.x()); py[i] = float(p.y()); pz[i] = float(p.z());
+        nx[i] = float(normal.x()); ny[i] = float(normal.y()); nz[i] = float(normal.z());
+        dx[i] = float(dir.x()); dy[i] = float(dir.y()); dz[i] = float(dir.z());
+        ka_r[i] = float(ka.x()); ka_g[i] = float(ka.y()); ka_b[i] = float(ka.z());
+        kd_r[i] = float(kd.x()); kd_g[i] = float(kd.y()); kd_b[i] = float(kd.z());
+        ks_r[i] = float(ks.x()); ks_g[i] = float(ks.y()); ks_b[i] = float(ks.z());
+        shininess[i] = float(m);
+        pixel.push_back(pix);
+        return i;
+    }
+
+    void set_visible(int luz, int i, bool v) { vis[size_t(luz) * capacity() + i] = v ? 1.0f : 0.0f; }
+
+    // pontos a processar, incluindo o enchimento até múltiplo de 16
+    int padded_size() const { return (n + lanes - 1) / lanes * lanes; }
+
+    // põe pontos neutros entre size() e padded_size()
+    void pad() {
+        for (int i = n; i < padded_size(); ++i) {
+            px[i] = py[i] = pz[i] = 0.0f;
+            nx[i] = 0.0f; ny[i] = 1.0f; nz[i] = 0.0f;
+            dx[i] = 0.0f; dy[i] = 0.0f; dz[i] = -1.0f;
+            ka_r[i] = ka_g[i] = ka_b[i] = 0.0f;
+            kd_r[i] = kd_g[i] = kd_b[i] = 0.0f;
+            ks_r[i] = ks_g[i] = ks_b[i] = 0.0f;
+            shininess[i] = 1.0f;
+            for (int k = 0; k < luzes; ++k) vis[size_t(k) * capacity() + i] = 0.0f;
+        }
+    }
+
+  private:
+    int n = 0;
+    int luzes;
+
+    void grow() {
+        size_t cap = std::max<size_t>(lanes * 16, px.size() * 2);
+        for (auto* v : {&px, &py, &pz, &nx, &ny, &nz, &dx, &dy, &dz, &ka_r, &ka_g, &ka_b,
+                        &kd_r, &kd_g, &kd_b, &ks_r, &ks_g, &ks_b, &shininess})
+            v->resize(cap);
+        // vis é indexado por capacidade: as linhas mudam de lugar
+        std::vector<float> novo(size_t(luzes) * cap, 0.0f);
+        size_t antiga = vis.size() / std::max(luzes, 1);
+        for (int k = 0; k < luzes; ++k)
+            std::copy(vis.begin() + k * antiga, vis.begin() + k * antiga + n, novo.begin() + k * cap);
+        vis.swap(novo);
+    }
+};
+
+// saída do lote: cor de cada ponto, em arrays
+struct batch_colors {
+    std::vector<float> r, g, b;
+
+    void resize(int n) { r.resize(n); g.resize(n); b.resize(n); }
+    color at(int i) const { return color(r[i], g[i], b[i]); }
+};
+
+// referência: double e std::pow, um ponto por vez
+inline void shade_batch_reference(const hit_batch& b, const std::vector<batch_light>& luzes,
+                                  const color& ambiente, batch_colors& out) {
+    out.resize(b.padded_size());
+    for (int i = 0; i < b.size(); ++i) {
+        point3 p(b.px[i], b.py[i], b.pz[i]);
+        vec3 n(b.nx[i], b.ny[i], b.nz[i]);
+        vec3 v = unit_vector(-vec3(b.dx[i], b.dy[i], b.dz[i]));
+        color kd(b.kd_r[i], b.kd_g[i], b.kd_b[i]);
+        color ks(b.ks_r[i], b.ks_g[i], b.ks_b[i]);
+        color cor = ambiente * color(b.ka_r[i], b.ka_g[i], b.ka_b[i]);
+        for (int k = 0; k < int(luzes.size()); ++k) {
+            if (b.vis[size_t(k) * b.capacity() + i] == 0.0f) continue;
+            const batch_light& luz = luzes[k];
+            color intensidade(luz.r, luz.g, luz.b);
+            vec3 l = unit_vector(point3(luz.x, luz.y, luz.z) - p);
+            vec3 rfl = reflect(-l, n);
+            double diff = std::max(0.0, dot(l, n));
+            double spec = std::pow(std::max(0.0, dot(v, rfl)), double(b.shininess[i]));
+            cor = cor + intensidade * kd * diff + intensidade * ks * spec;
+        }
+        out.r[i] = float(cor.x()); out.g[i] = float(cor.y()); out.b[i] = float(cor.z());
+    }
+}
+
+// caminho escalar: as contas do núcleo vetorial, um ponto por vez
+inline void shade_batch_scalar(const hit_batch& b, const std::vector<batch_light>& luzes,
+                               const color& ambiente, batch_colors& out) {
+    const float ar = float(ambiente.x()), ag = float(ambiente.y()), ab = float(ambiente.z());
+    for (int i = 0; i < b.padded_size(); ++i) {
+        float cr = ar * b.ka_r[i], cg = ag * b.ka_g[i], cb = ab * b.ka_b[i];
+
+        float inv = 1.0f / std::sqrt(b.dx[i] * b.dx[i] + b.dy[i] * b.dy[i] + b.dz[i] * b.dz[i]);
+        float vx = -b.dx[i] * inv, vy = -b.dy[i] * inv, vz = -b.dz[i] * inv;
+
+        for (int k = 0; k < int(luzes.size()); ++k) {
+            const batch_light& luz = luzes[k];
+            float lx = luz.x - b.px[i], ly = luz.y - b.py[i], lz = luz.z - b.pz[i];
+            float il = 1.0f / std::sqrt(lx * lx + ly * ly + lz * lz);
+            lx *= il; ly *= il; lz *= il;
+
+            // reflect(-l, n) = 2 (l·n) n - l
+            float ln = lx * b.nx[i] + ly * b.ny[i] + lz * b.nz[i];
+            float rx = 2.0f * ln * b.nx[i] - lx;
+            float ry = 2.0f * ln * b.ny[i] - ly;
+            float rz = 2.0f * ln * b.nz[i] - lz;
+
+            float w = b.vis[size_t(k) * b.capacity() + i];
+            float diff = std::max(0.0f, ln) * w;
+            float spec = fast_pow(std::max(0.0f, vx * rx + vy * ry + vz * rz), b.shininess[i]) * w;
+
+            cr += luz.r * (b.kd_r[i] * diff + b.ks_r[i] * spec);
+            cg += luz.g * (b.kd_g[i] * diff + b.ks_g[i] * spec);
+            cb += luz.b * (b.kd_b[i] * diff + b.ks_b[i] * spec);
+        }
+        out.r[i] = cr; out.g[i] = cg; out.b[i] = cb;
+    }
+}
+
+#ifdef SHADE_BATCH_X86
+
+// ---- AVX2: 8 pontos por vez ----
+
+__attribute__((target("avx2,fma")))
+inline __m256 fast_log2_avx2(__m256 x) {
+    __m256i bits = _mm256_castps_si256(x);
+    __m256 e = _mm256_cvtepi32_ps(_mm256_sub_epi32(
+        _mm256_and_si256(_mm256_srli_epi32(bits, 23), _mm256_set1_epi32(255)), _mm256_set1_epi32(127)));
+    __m256 mm = _mm256_castsi256_ps(_mm256_or_si256(
+        _mm256_and_si256(bits, _mm256_set1_epi32(0x7fffff)), _mm256_set1_epi32(0x3f800000)));
+    __m256 maior = _mm256_cmp_ps(mm, _mm256_set1_ps(1.41421356f), _CMP_GT_OQ);
+    mm = _mm256_blendv_ps(mm, _mm256_mul_ps(mm, _mm256_set1_ps(0.5f)), maior);
+    e = _mm256_add_ps(e, _mm256_and_ps(maior, _mm256_set1_ps(1.0f)));
+
+    __m256 um = _mm256_set1_ps(1.0f);
+    __m256 f = _mm256_div_ps(_mm256_sub_ps(mm, um), _mm256_add_ps(mm, um));
+    __m256 f2 = _mm256_mul_ps(f, f);
+    __m256 s = _mm256_fmadd_ps(f2, _mm256_set1_ps(1.0f / 7), _mm256_set1_ps(1.0f / 5));
+    s = _mm256_fmadd_ps(f2, s, _mm256_set1_ps(1.0f / 3));
+    s = _mm256_fmadd_ps(f2, s, um);
+    __m256 ln = _mm256_mul_ps(_mm256_mul_ps(_mm256_set1_ps(2.0f), f), s);
+    return _mm256_fmadd_ps(ln, _mm256_set1_ps(1.44269504f), e);
+}
+
+__attribute__((target("avx2,fma")))
+inline __m256 fast_exp2_avx2(__m256 y) {
+    y = _mm256_max_ps(y, _mm256_set1_ps(-126.0f));
+    __m256 i = _mm256_round_ps(y, _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+    __m256 f = _mm256_sub_ps(y, i);
+    __m256 p = _mm256_fmadd_ps(_mm256_set1_ps(1.535336188e-4f), f, _mm256_set1_ps(1.339887440e-3f));
+    p = _mm256_fmadd_ps(p, f, _mm256_set1_ps(9.618437357e-3f));
+    p = _mm256_fmadd_ps(p, f, _mm256_set1_ps(5.550332471e-2f));
+    p = _mm256_fmadd_ps(p, f, _mm256_set1_ps(2.402264791e-1f));
+    p = _mm256_fmadd_ps(p, f, _mm256_set1_ps(6.931472028e-1f));
+    p = _mm256_fmadd_ps(p, f, _mm256_set1_ps(1.0f));
+    __m256i escala = _mm256_slli_epi32(_mm256_add_epi32(_mm256_cvtps_epi32(i), _mm256_set1_epi32(127)), 23);
+    return _mm256_mul_ps(p, _mm256_castsi256_ps(escala));
+}
+
+__attribute__((target("avx2,fma")))
+inline void shade_batch_avx2(const hit_batch& b, const std::vector<batch_light>& luzes,
+                             const color& ambiente, batch_colors& out) {
+    const __m256 zero = _mm256_setzero_ps();
+    const __m256 um = _mm256_set1_ps(1.0f);
+    const __m256 dois = _mm256_set1_ps(2.0f);
+    const __m256 ar = _mm256_set1_ps(float(ambiente.x()));
+    const __m256 ag = _mm256_set1_ps(float(ambiente.y()));
+    const __m256 ab = _mm256_set1_ps(float(ambiente.z()));
+
+    for (int i = 0; i < b.padded_size(); i += 8) {
+        __m256 px = _mm256_loadu_ps(&b.px[i]), py = _mm256_loadu_ps(&b.py[i]), pz = _mm256_loadu_ps(&b.pz[i]);
+        __m256 nx = _mm256_loadu_ps(&b.nx[i]), ny = _mm256_loadu_ps(&b.ny[i]), nz = _mm256_loadu_ps(&b.nz[i]);
+        __m256 dx = _mm256_loadu_ps(&b.dx[i]), dy = _mm256_loadu_ps(&b.dy[i]), dz = _mm256_loadu_ps(&b.dz[i]);
+        __m256 kdr = _mm256_loadu_ps(&b.kd_r[i]), kdg = _mm256_loadu_ps(&b.kd_g[i]), kdb = _mm256_loadu_ps(&b.kd_b[i]);
+        __m256 ksr = _mm256_loadu_ps(&b.ks_r[i]), ksg = _mm256_loadu_ps(&b.ks_g[i]), ksb = _mm256_loadu_ps(&b.ks_b[i]);
+        __m256 m = _mm256_loadu_ps(&b.shininess[i]);
+
+        __m256 cr = _mm256_mul_ps(ar, _mm256_loadu_ps(&b.ka_r[i]));
+        __m256 cg = _mm256_mul_ps(ag, _mm256_loadu_ps(&b.ka_g[i]));
+        __m256 cb = _mm256_mul_ps(ab, _mm256_loadu_ps(&b.ka_b[i]));
+
+        __m256 inv = _mm256_div_ps(um, _mm256_sqrt_ps(
+            _mm256_fmadd_ps(dx, dx, _mm256_fmadd_ps(dy, dy, _mm256_mul_ps(dz, dz)))));
+        __m256 vx = _mm256_sub_ps(zero, _mm256_mul_ps(dx, inv));
+        __m256 vy = _mm256_sub_ps(zero, _mm256_mul_ps(dy, inv));
+        __m256 vz = _mm256_sub_ps(zero, _mm256_mul_ps(dz, inv));
+
+        for (int k = 0; k < int(luzes.size()); ++k) {
+            const batch_light& luz = luzes[k];
+            __m256 lx = _mm256_sub_ps(_mm256_set1_ps(luz.x), px);
+            __m256 ly = _mm256_sub_ps(_mm256_set1_ps(luz.y), py);
+            __m256 lz = _mm256_sub_ps(_mm256_set1_ps(luz.z), pz);
+            __m256 il = _mm256_div_ps(um, _mm256_sqrt_ps(
+                _mm256_fmadd_ps(lx, lx, _mm256_fmadd_ps(ly, ly, _mm256_mul_ps(lz, lz)))));
+            lx = _mm256_mul_ps(lx, il); ly = _mm256_mul_ps(ly, il); lz = _mm256_mul_ps(lz, il);
+
+            __m256 ln = _mm256_fmadd_ps(lx, nx, _mm256_fmadd_ps(ly, ny, _mm256_mul_ps(lz, nz)));
+            __m256 ln2 = _mm256_mul_ps(dois, ln);
+            __m256 rx = _mm256_fmsub_ps(ln2, nx, lx);
+            __m256 ry = _mm256_fmsub_ps(ln2, ny, ly);
+            __m256 rz = _mm256_fmsub_ps(ln2, nz, lz);
+
+            __m256 w = _mm256_loadu_ps(&b.vis[size_t(k) * b.capacity() + i]);
+            __m256 diff = _mm256_mul_ps(_mm256_max_ps(zero, ln), w);
+            __m256 vr = _mm256_max_ps(zero, _mm256_fmadd_ps(vx, rx, _mm256_fmadd_ps(vy, ry, _mm256_mul_ps(vz, rz))));
+            __m256 spec = _mm256_mul_ps(fast_exp2_avx2(_mm256_mul_ps(m, fast_log2_avx2(vr))), w);
+
+            cr = _mm256_fmadd_ps(_mm256_set1_ps(luz.r), _mm256_fmadd_ps(kdr, diff, _mm256_mul_ps(ksr, spec)), cr);
+            cg = _mm256_fmadd_ps(_mm256_set1_ps(luz.g), _mm256_fmadd_ps(kdg, diff, _mm256_mul_ps(ksg, spec)), cg);
+            cb = _mm256_fmadd_ps(_mm256_set1_ps(luz.b), _mm256_fmadd_ps(kdb, diff, _mm256_mul_ps(ksb, spec)), cb);
+        }
+        _mm256_storeu_ps(&out.r[i], cr);
+        _mm256_storeu_ps(&out.g[i], cg);
+        _mm256_storeu_ps(&out.b[i], cb);
+    }
+}
+
+// ---- AVX-512: 16 pontos por vez ----
+
+// o gcc 12 acusa falsamente __Y não inicializado dentro de avx512fintrin.h
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+
+__attribute__((target("avx512f")))
+inline __m512 fast_log2_avx512(__m512 x) {
+    __m512i bits = _mm512_castps_si512(x);
+    __m512 e = _mm512_cvtepi32_ps(_mm512_sub_epi32(
+        _mm512_and_si512(_mm512_srli_epi32(bits, 23), _mm512_set1_epi32(255)), _mm512_set1_epi32(127)));
+    __m512 mm = _mm512_castsi512_ps(_mm512_or_si512(
+        _mm512_and_si512(bits, _mm512_set1_epi32(0x7fffff)), _mm512_set1_epi32(0x3f800000)));
+    __mmask16 maior = _mm512_cmp_ps_mask(mm, _mm512_set1_ps(1.41421356f), _CMP_GT_OQ);
+    mm = _mm512_mask_mul_ps(mm, maior, mm, _mm512_set1_ps(0.5f));
+    e = _mm512_mask_add_ps(e, maior, e, _mm512_set1_ps(1.0f));
+
+    __m512 um = _mm512_set1_ps(1.0f);
+    __m512 f = _mm512_div_ps(_mm512_sub_ps(mm, um), _mm512_add_ps(mm, um));
+    __m512 f2 = _mm512_mul_ps(f, f);
+    __m512 s = _mm512_fmadd_ps(f2, _mm512_set1_ps(1.0f / 7), _mm512_set1_ps(1.0f / 5));
+    s = _mm512_fmadd_ps(f2, s, _mm512_set1_ps(1.0f / 3));
+    s = _mm512_fmadd_ps(f2, s, um);
+    __m512 ln = _mm512_mul_ps(_mm512_mul_ps(_mm512_set1_ps(2.0f), f), s);
+    return _mm512_fmadd_ps(ln, _mm512_set1_ps(1.44269504f), e);
+}
+
+__attribute__((target("avx512f")))
+inline __m512 fast_exp2_avx512(__m512 y) {
+    y = _mm512_max_ps(y, _mm512_set1_ps(-126.0f));
+    __m512 i = _mm512_roundscale_ps(y, _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+    __m512 f = _mm512_sub_ps(y, i);
+    __m512 p = _mm512_fmadd_ps(_mm512_set1_ps(1.535336188e-4f), f, _mm512_set1_ps(1.339887440e-3f));
+    p = _mm512_fmadd_ps(p, f, _mm512_set1_ps(9.618437357e-3f));
+    p = _mm512_fmadd_ps(p, f, _mm512_set1_ps(5.550332471e-2f));
+    p = _mm512_fmadd_ps(p, f, _mm512_set1_ps(2.402264791e-1f));
+    p = _mm512_fmadd_ps(p, f, _mm512_set1_ps(6.931472028e-1f));
+    p = _mm512_fmadd_ps(p, f, _mm512_set1_ps(1.0f));
+    __m512i escala = _mm512_slli_epi32(_mm512_add_epi32(_mm512_cvtps_epi32(i), _mm512_set1_epi32(127)), 23);
+    return _mm512_mul_ps(p, _mm512_castsi512_ps(escala));
+}
+
+__attribute__((target("avx512f")))
+inline void shade_batch_avx512(const hit_batch& b, const std::vector<batch_light>& luzes,
+                               const color& ambiente, batch_colors& out) {
+    const __m512 zero = _mm512_setzero_ps();
+    const __m512 um = _mm512_set1_ps(1.0f);
+    const __m512 dois = _mm512_set1_ps(2.0f);
+    const __m512 ar = _mm512_set1_ps(float(ambiente.x()));
+    const __m512 ag = _mm512_set1_ps(float(ambiente.y()));
+    const __m512 ab = _mm512_set1_ps(float(ambiente.z()));
+
+    for (int i = 0; i < b.padded_size(); i += 16) {
+        __m512 px = _mm512_loadu_ps(&b.px[i]), py = _mm512_loadu_ps(&b.py[i]), pz = _mm512_loadu_ps(&b.pz[i]);
+        __m512 nx = _mm512_loadu_ps(&b.nx[i]), ny = _mm512_loadu_ps(&b.ny[i]), nz = _mm512_loadu_ps(&b.nz[i]);
+        __m512 dx = _mm512_loadu_ps(&b.dx[i]), dy = _mm512_loadu_ps(&b.dy[i]), dz = _mm512_loadu_ps(&b.dz[i]);
+        __m512 kdr = _mm512_loadu_ps(&b.kd_r[i]), kdg = _mm512_loadu_ps(&b.kd_g[i]), kdb = _mm512_loadu_ps(&b.kd_b[i]);
+        __m512 ksr = _mm512_loadu_ps(&b.ks_r[i]), ksg = _mm512_loadu_ps(&b.ks_g[i]), ksb = _mm512_loadu_ps(&b.ks_b[i]);
+        __m512 m = _mm512_loadu_ps(&b.shininess[i]);
+
+        __m512 cr = _mm512_mul_ps(ar, _mm512_loadu_ps(&b.ka_r[i]));
+        __m512 cg = _mm512_mul_ps(ag, _mm512_loadu_ps(&b.ka_g[i]));
+        __m512 cb = _mm512_mul_ps(ab, _mm512_loadu_ps(&b.ka_b[i]));
+
+        __m512 inv = _mm512_div_ps(um, _mm512_sqrt_ps(
+            _mm512_fmadd_ps(dx, dx, _mm512_fmadd_ps(dy, dy, _mm512_mul_ps(dz, dz)))));
+        __m512 vx = _mm512_sub_ps(zero, _mm512_mul_ps(dx, inv));
+        __m512 vy = _mm512_sub_ps(zero, _mm512_mul_ps(dy, inv));
+        __m512 vz = _mm512_sub_ps(zero, _mm512_mul_ps(dz, inv));
+
+        for (int k = 0; k < int(luzes.size()); ++k) {
+            const batch_light& luz = luzes[k];
+            __m512 lx = _mm512_sub_ps(_mm512_set1_ps(luz.x), px);
+            __m512 ly = _mm512_sub_ps(_mm512_set1_ps(luz.y), py);
+            __m512 lz = _mm512_sub_ps(_mm512_set1_ps(luz.z), pz);
+            __m512 il = _mm512_div_ps(um, _mm512_sqrt_ps(
+                _mm512_fmadd_ps(lx, lx, _mm512_fmadd_ps(ly, ly, _mm512_mul_ps(lz, lz)))));
+            lx = _mm512_mul_ps(lx, il); ly = _mm512_mul_ps(ly, il); lz = _mm512_mul_ps(lz, il);
+
+            __m512 ln = _mm512_fmadd_ps(lx, nx, _mm512_fmadd_ps(ly, ny, _mm512_mul_ps(lz, nz)));
+            __m512 ln2 = _mm512_mul_ps(dois, ln);
+            __m512 rx = _mm512_fmsub_ps(ln2, nx, lx);
+            __m512 ry = _mm512_fmsub_ps(ln2, ny, ly);
+            __m512 rz = _mm512_fmsub_ps(ln2, nz, lz);
+
+            __m512 w = _mm512_loadu_ps(&b.vis[size_t(k) * b.capacity() + i]);
+            __m512 diff = _mm512_mul_ps(_mm512_max_ps(zero, ln), w);
+            __m512 vr = _mm512_max_ps(zero, _mm512_fmadd_ps(vx, rx, _mm512_fmadd_ps(vy, ry, _mm512_mul_ps(vz, rz))));
+            __m512 spec = _mm512_mul_ps(fast_exp2_avx512(_mm512_mul_ps(m, fast_log2_avx512(vr))), w);
+
+            cr = _mm512_fmadd_ps(_mm512_set1_ps(luz.r), _mm512_fmadd_ps(kdr, diff, _mm512_mul_ps(ksr, spec)), cr);
+            cg = _mm512_fmadd_ps(_mm512_set1_ps(luz.g), _mm512_fmadd_ps(kdg, diff, _mm512_mul_ps(ksg, spec)), cg);
+            cb = _mm512_fmadd_ps(_mm512_set1_ps(luz.b), _mm512_fmadd_ps(kdb, diff, _mm512_mul_ps(ksb, spec)), cb);
+        }
+        _mm512_storeu_ps(&out.r[i], cr);
+        _mm512_storeu_ps(&out.g[i], cg);
+        _mm512_storeu_ps(&out.b[i], cb);
+    }
+}
+
+#pragma GCC diagnostic pop
+
+#endif
+
+// sombreia o lote inteiro (b.pad() já chamado) com o conjunto pedido;
+// sem suporte na máquina, cai no escalar
+inline void shade_batch(const hit_batch& b, const std::vector<batch_light>& luzes,
+                        const color& ambiente, simd_isa isa, batch_colors& out) {
+    out.resize(b.padded_size());
+#ifdef SHADE_BATCH_X86
+    if (isa == simd_isa::avx512 && simd_supported(isa)) return shade_batch_avx512(b, luzes, ambiente, out);
+    if (isa == simd_isa::avx2 && simd_supported(isa)) return shade_batch_avx2(b, luzes, ambiente, out);
+#else
+    (void)isa;
+#endif
+    shade_batch_scalar(b, luzes, ambiente, out);
+}
+
+#endif
@@ -0,0 +1,70 @@
+#ifndef SHADING_H
+#define SHADING_H
+
+#include "../colors/color.h"
+#include "../vectors/vec3.h"
+
+#include <algorithm>
+
+/**
+ * peças do sombreamento de Phong especializadas por template
+ *
+ * o sombreamento é escolhido uma vez por material (e objeto) pelos
+ * seus traços, em vez de testado termo a termo:
+ *   - Especular: k_specular não nulo. sem ele, o reflexo, o pow e a
+ *     parcela especular nem são compilados;
+ *   - Sombra: o objeto recebe sombra. sem ele, os raios de sombra
+ *     somem do código;
+ *   - Expoente: brilho conhecido em tempo de compilação (cenários
+ *     assados); -1 usa o brilho do material em tempo de execução.
+ * o brilho é sempre inteiro, então o pow vira multiplicações.
+ */
+
+// x^n (n >= 0) por quadrados sucessivos, da direita para a esquerda
+inline double ipow(double x, int n) {
+    double r = 1.0;
+    while (n > 0) {
+        if (n & 1) r *= x;
+        x *= x;
+        n >>= 1;
+    }
+    return r;
+}
+
+// o mesmo, desenrolado para um expoente fixo (mesmas multiplicações,
+// mesmo resultado)
+template <int N>
+inline double ipow(double x, double r = 1.0) {
+    if constexpr (N <= 0) {
+        (void)x;
+        return r;
+    } else {
+        return ipow<N / 2>(x * x, (N & 1) ? r * x : r);
+    }
+}
+
+// termos de Phong de uma luz com direção l (unitária) vista de v
+// I_d e I_e recebem intensidade * k * termo; sem Especular, I_e fica
+// intocado
+template <bool Especular, int Expoente = -1>
+inline void phong(const vec3& l, const vec3& n, const vec3& v, const color& intensidade,
+                  const color& kd, const color& ks, int shininess, color& I_d, color& I_e) {
+    double diff = std::max(0.0, dot(l, n));
+    I_d = intensidade * kd * diff;
+    if constexpr (Especular) {
+        vec3 rfl = reflect(-l, n);
+        double c = std::max(0.0, dot(v, rfl));
+        double spec;
+        if constexpr (Expoente >= 0) {
+            (void)shininess;
+            spec = ipow<Expoente>(c);
+        } else {
+            spec = ipow(c, shininess);
+        }
+        I_e = intensidade * ks * spec;
+    } else {
+        (void)v; (void)ks; (void)shininess; (void)I_e;
+    }
+}
+
+#endif
@@ -0,0 +1,120 @@
+#ifndef TEMPORAL_H
+#define TEMPORAL_H
+
+#include "../accel/aabb.h"
+#include "../objects/hittable.h"
+#include "camera.h"
+#include "framebuffer.h"
+#include "thread_pool.h"
+
+#include <atomic>
+#include <cstddef>
+#include <limits>
+#include <vector>
+
+/**
+ * cache de reprojeção temporal para sequências com câmera parada
+ *
+ * guarda, por pixel, a cor e o ponto de interseção do raio primário
+ * no quadro anterior. no quadro seguinte, um pixel
+ * só é retraçado se o raio primário (até o ponto atingido) ou o raio
+ * de sombra (do ponto até cada luz) passa por alguma das caixas dos objetos
+ * que se moveram. essas caixas devem cobrir a posição antiga e a nova
+ * de cada objeto: se nenhum dos dois segmentos toca nelas, o traçado
+ * daria exatamente o mesmo resultado e a cor é reaproveitada.
+ *
+ * o custo de um quadro fica proporcional à área afetada pela mudança,
+ * não ao tamanho da imagem. vale para luzes fixas e iluminação direta:
+ * raios de oclusão ambiente, luz indireta ou um cache de irradiância
+ * não passam por esses testes, e o resultado sairia desatualizado. os
+ * testes contra as caixas custam O(k * luzes) por pixel para k objetos
+ * movidos.
+ */
+class temporal_cache {
+  public:
+    temporal_cache(int w, int h) : width(w), height(h), entries(size_t(w) * h) {}
+
+    // esquece tudo (mudança de câmera, luz ou cenário inteiro)
+    void invalidate() {
+        for (auto& e : entries) e.valid = false;
+    }
+
+    /**
+     * renderiza um quadro em fb e devolve quantos pixels foram retraçados
+     * lights: caixa de cada luz (um ponto só, para as pontuais)
+     * moved: caixas (antiga ∪ nova) dos objetos que se moveram desde o
+     * quadro anterior; trace(r, rec) devolve a cor e preenche rec com a
+     * interseção primária (rec.obj == nullptr se o raio não atingiu nada)
+     */
+    template <class Trace>
+    std::size_t render_frame(thread_pool& pool, const camera& cam, const std::vector<aabb>& lights,
+                             const std::vector<aabb>& moved, framebuffer& fb, const Trace& trace) {
+        std::atomic<std::size_t> retracados{0};
+        const double tmin = 0.001;
+
+        pool.parallel_for(height, [&](int l) {
+            std::size_t n = 0;
+            for (int c = 0; c < width; ++c) {
+                entry& e = entries[size_t(l) * width + c];
+                ray r = cam.get_ray(c, l);
+
+                if (e.valid && !affected(e, r, tmin, lights, moved)) {
+                    fb.at(c, l) = e.cor;
+                    continue;
+                }
+
+                hit_record rec;
+                e.cor = trace(r, rec);
+                e.atingiu = rec.obj != nullptr;
+                e.t = rec.obj ? rec.t : std::numeric_limits<double>::infinity();
+                e.p = rec.p;
+                e.valid = true;
+                fb.at(c, l) = e.cor;
+                n++;
+            }
+            retracados += n;
+        });
+
+        return retracados;
+    }
+
+  private:
+    static bool overlaps(const aabb& a, const aabb& b) {
+        return a.pmin.x() <= b.pmax.x() && b.pmin.x() <= a.pmax.x() &&
+               a.pmin.y() <= b.pmax.y() && b.pmin.y() <= a.pmax.y() &&
+               a.pmin.z() <= b.pmax.z() && b.pmin.z() <= a.pmax.z();
+    }
+
+    struct entry {
+        color cor;
+        point3 p;
+        double t = 0.0;
+        bool atingiu = false;
+        bool valid = false;
+    };
+
+    int width, height;
+    std::vector<entry> entries;
+
+    static bool affected(const entry& e, const ray& r, double tmin, const std::vector<aabb>& lights,
+                         const std::vector<aabb>& moved) {
+        for (const aabb& box : moved) {
+            // raio primário até o ponto atingido (ou até o infinito)
+            if (box.hit(r, tmin, e.t)) return true;
+
+            // raios de sombra: do ponto atingido até cada luz. para uma
+            // luz de área, os raios ficam dentro da caixa de (p ∪ luz)
+            if (!e.atingiu) continue;
+            for (const aabb& luz : lights) {
+                if (luz.surface_area() == 0.0) {
+                    if (box.hit(ray(e.p, luz.pmin - e.p), 0.0, 1.0)) return true;
+                } else if (overlaps(box, aabb(luz, aabb(e.p, e.p)))) {
+                    return true;
+                }
+            }
+        }
+        return false;
+    }
+};
+
+#endif
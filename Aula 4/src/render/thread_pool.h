@@ -0,0 +1,107 @@
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * conjunto fixo de threads que executa tarefas de uma fila
+ * criado uma vez e reaproveitado por todas as renderizações
+ */
+class thread_pool {
+  public:
+    explicit thread_pool(int n = default_size()) {
+        n = std::max(1, n);
+        for (int i = 0; i < n; ++i)
+            workers.emplace_back([this, i] { run(i); });
+    }
+
+    ~thread_pool() {
+        {
+            std::lock_guard<std::mutex> lock(mtx);
+            stopping = true;
+        }
+        cv.notify_all();
+        for (auto& w : workers) w.join();
+    }
+
+    thread_pool(const thread_pool&) = delete;
+    thread_pool& operator=(const thread_pool&) = delete;
+
+    static int default_size() {
+        return std::max(1u, std::thread::hardware_concurrency());
+    }
+
+    int size() const { return int(workers.size()); }
+
+    // índice da thread do pool que está executando (-1 fora do pool)
+    static int worker_index() { return current_worker(); }
+
+    // enfileira uma tarefa avulsa
+    void submit(std::function<void()> task) {
+        {
+            std::lock_guard<std::mutex> lock(mtx);
+            tasks.push_back(std::move(task));
+        }
+        cv.notify_one();
+    }
+
+    // executa f(i) para i em [0, n), distribuindo os índices
+    // dinamicamente entre as threads; bloqueia até terminar
+    void parallel_for(int n, const std::function<void(int)>& f) {
+        if (n <= 0) return;
+
+        std::atomic<int> next{0};
+        int pendentes = std::min(n, size());
+        std::mutex done_mtx;
+        std::condition_variable done_cv;
+
+        for (int k = 0, total = pendentes; k < total; ++k) {
+            submit([&] {
+                for (int i = next++; i < n; i = next++)
+                    f(i);
+
+                std::lock_guard<std::mutex> lock(done_mtx);
+                if (--pendentes == 0) done_cv.notify_one();
+            });
+        }
+
+        std::unique_lock<std::mutex> lock(done_mtx);
+        done_cv.wait(lock, [&] { return pendentes == 0; });
+    }
+
+  private:
+    std::vector<std::thread> workers;
+    std::deque<std::function<void()>> tasks;
+    std::mutex mtx;
+    std::condition_variable cv;
+    bool stopping = false;
+
+    static int& current_worker() {
+        static thread_local int idx = -1;
+        return idx;
+    }
+
+    void run(int idx) {
+        current_worker() = idx;
+        for (;;) {
+            std::function<void()> task;
+            {
+                std::unique_lock<std::mutex> lock(mtx);
+                cv.wait(lock, [this] { return stopping || !tasks.empty(); });
+                if (stopping && tasks.empty()) return;
+                task = std::move(tasks.front());
+                tasks.pop_front();
+            }
+            task();
+        }
+    }
+};
+
+#endif
@@ -0,0 +1,122 @@
+#ifndef BLUE_NOISE_H
+#define BLUE_NOISE_H
+
+#include "../util/rng.h"
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+/**
+ * máscara de ruído azul (void-and-cluster de Ulichney), periódica,
+ * com os valores 0 .. n*n-1 permutados de forma que qualquer limiar
+ * produz pontos bem espalhados, sem aglomerados nem buracos
+ *
+ * a máscara é determinística (semente fixa): gerada uma vez, na
+ * primeira chamada de blue_noise_mask(), e depois só lida.
+ */
+class blue_noise {
+  public:
+    static constexpr int size = 64;
+
+    // posto de (x, y) na máscara, em [0, size*size), com repetição periódica
+    int rank(int x, int y) const {
+        x &= size - 1;
+        y &= size - 1;
+        return ranks[y * size + x];
+    }
+
+    // mesmo valor em [0, 1), no centro do intervalo do posto
+    double value(int x, int y) const { return (rank(x, y) + 0.5) / (size * size); }
+
+    explicit blue_noise(std::uint64_t seed) : ranks(size * size, 0) {
+        const int n = size * size;
+        const double sigma = 1.5;
+
+        // núcleo gaussiano pela distância periódica
+        std::vector<double> kernel(n);
+        for (int dy = 0; dy < size; ++dy) {
+            for (int dx = 0; dx < size; ++dx) {
+                int ex = std::min(dx, size - dx), ey = std::min(dy, size - dy);
+                kernel[dy * size + dx] = std::exp(-(ex * ex + ey * ey) / (2 * sigma * sigma));
+            }
+        }
+
+        std::vector<char> bits(n, 0);
+        std::vector<double> energia(n, 0.0);
+        auto muda = [&](int p, double sinal) {
+            int px = p % size, py = p / size;
+            for (int y = 0; y < size; ++y) {
+                const double* k = &kernel[((y - py) & (size - 1)) * size];
+                double* e = &energia[y * size];
+                for (int x = 0; x < size; ++x) e[x] += sinal * k[(x - px) & (size - 1)];
+            }
+        };
+        // maior aglomerado: 1 com mais energia; maior vazio: 0 com menos
+        auto aglomerado = [&]() {
+            int melhor = -1;
+            for (int p = 0; p < n; ++p)
+                if (bits[p] && (melhor < 0 || energia[p] > energia[melhor])) melhor = p;
+            return melhor;
+        };
+        auto vazio = [&]() {
+            int melhor = -1;
+            for (int p = 0; p < n; ++p)
+                if (!bits[p] && (melhor < 0 || energia[p] < energia[melhor])) melhor = p;
+            return melhor;
+        };
+
+        // padrão inicial: ~10% de pontos aleatórios, depois redistribuídos
+        // movendo o maior aglomerado para o maior vazio até estabilizar
+        rng g(seed);
+        int uns = n / 10;
+        for (int k = 0; k < uns;) {
+            int p = int(g.uniform() * n);
+            if (bits[p]) continue;
+            bits[p] = 1;
+            muda(p, 1.0);
+            ++k;
+        }
+        for (;;) {
+            int a = aglomerado();
+            bits[a] = 0;
+            muda(a, -1.0);
+            int v = vazio();
+            bits[v] = 1;
+            muda(v, 1.0);
+            if (v == a) break;
+        }
+
+        // fase 1: tira os aglomerados do padrão inicial, postos decrescentes
+        std::vector<char> inicial = bits;
+        std::vector<double> energia_inicial = energia;
+        for (int r = uns - 1; r >= 0; --r) {
+            int a = aglomerado();
+            bits[a] = 0;
+            muda(a, -1.0);
+            ranks[a] = r;
+        }
+
+        // fases 2 e 3: enche os maiores vazios, postos crescentes. depois
+        // da metade, o "maior aglomerado de zeros" é o mesmo ponto que o
+        // maior vazio de uns (a energia total de cada ponto é constante)
+        bits = inicial;
+        energia = energia_inicial;
+        for (int r = uns; r < n; ++r) {
+            int v = vazio();
+            bits[v] = 1;
+            muda(v, 1.0);
+            ranks[v] = r;
+        }
+    }
+
+  private:
+    std::vector<int> ranks;
+};
+
+inline const blue_noise& blue_noise_mask() {
+    static const blue_noise mascara(0x5eed);
+    return mascara;
+}
+
+#endif
@@ -0,0 +1,218 @@
+#ifndef SAMPLER_H
+#define SAMPLER_H
+
+#include "../util/rng.h"
+#include "blue_noise.h"
+
+#include <cmath>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+
+/**
+ * fonte de amostras 2D em [0, 1)^2 para tudo que integra por pixel
+ * (anti-aliasing, luzes de área, oclusão ambiente)
+ *
+ * get_2d(c, l, amostra, dim) é uma função pura de (pixel, índice da
+ * amostra, dimensão, semente): não há estado por thread, então o
+ * resultado não depende da ordem dos tiles nem da quantidade de threads.
+ * 'dim' separa os usos dentro da mesma amostra (0 = posição no pixel,
+ * 1 = luz, ...); cada par (pixel, dim) tem uma sequência descorrelacionada
+ * das outras.
+ *
+ * - independent: pseudoaleatório puro, erro ~ 1/sqrt(n)
+ * - stratified: grade de spp estratos com jitter, estratos em ordem
+ *   embaralhada por pixel (pede o spp total no construtor)
+ * - sobol: os dois primeiros eixos de Sobol (0,2)-sequência, com
+ *   embaralhamento de Owen por hash (Burley 2020): qualquer prefixo de
+ *   potência de 2 é bem estratificado, sem precisar saber o spp
+ * - blue_noise: máscara void-and-cluster deslocada por dimensão, com a
+ *   sequência R2 entre amostras; o erro fica espalhado em alta
+ *   frequência entre pixels vizinhos (parece ruído fino, não manchas)
+ */
+class sampler {
+  public:
+    enum class kind { independent, stratified, sobol, blue_noise };
+
+    sampler(kind k, int spp, std::uint64_t seed = 0) : tipo(k), spp(spp < 1 ? 1 : spp), seed(seed) {
+        nx = int(std::sqrt(double(this->spp)));
+        ny = (this->spp + nx - 1) / nx;
+        if (tipo == kind::blue_noise) blue_noise_mask();
+    }
+
+    kind type() const { return tipo; }
+    int samples_per_pixel() const { return spp; }
+
+    void get_2d(int c, int l, int amostra, int dim, double& u, double& v) const {
+        std::uint64_t h = pixel_seed(c, l, dim, seed);
+        switch (tipo) {
+        case kind::stratified: {
+            // estrato embaralhado por pixel; amostras além do spp repetem a grade
+            int n = nx * ny;
+            int s = int(permute(std::uint32_t(amostra % n), std::uint32_t(n), std::uint32_t(h)));
+            rng g(h ^ (std::uint64_t(amostra) * 0xd1b54a32d192ed03ull));
+            u = (s % nx + g.uniform()) / nx;
+            v = (s / nx + g.uniform()) / ny;
+            break;
+        }
+        case kind::sobol: {
+            std::uint32_t semente = std::uint32_t(h) ^ std::uint32_t(h >> 32);
+            std::uint32_t i = owen_scramble(std::uint32_t(amostra), hash(semente));
+            u = to_unit(owen_scramble(reverse_bits(i), hash(semente + 1)));
+            v = to_unit(owen_scramble(sobol_dim1(i), hash(semente + 2)));
+            break;
+        }
+        case kind::blue_noise: {
+            // a máscara descorrelaciona os pixels; R2 (razão plástica)
+            // espalha as amostras do mesmo pixel
+            const blue_noise& m = blue_noise_mask();
+            int ox = int(h & 63), oy = int((h >> 6) & 63);
+            const double a1 = 0.7548776662466927, a2 = 0.5698402909980532;
+            u = frac(m.value(c + ox, l + oy) + a1 * amostra);
+            v = frac(m.value(c + ox + 32, l + oy + 17) + a2 * amostra);
+            break;
+        }
+        default: {
+            rng g(h ^ (std::uint64_t(amostra) * 0xd1b54a32d192ed03ull));
+            u = g.uniform();
+            v = g.uniform();
+            break;
+        }
+        }
+    }
+
+    // geração em lote: as amostras first .. first+n-1 do pixel (c, l) na
+    // dimensão dim, intercaladas em uv[0 .. 2n). os mesmos valores de
+    // get_2d, mas o hash do pixel e as sementes saem uma vez por lote
+    void fill_2d(int c, int l, int dim, int first, int n, double* uv) const {
+        std::uint64_t h = pixel_seed(c, l, dim, seed);
+        switch (tipo) {
+        case kind::stratified: {
+            int total = nx * ny;
+            for (int k = 0; k < n; ++k) {
+                int amostra = first + k;
+                int s = int(permute(std::uint32_t(amostra % total), std::uint32_t(total), std::uint32_t(h)));
+                rng g(h ^ (std::uint64_t(amostra) * 0xd1b54a32d192ed03ull));
+                uv[2 * k] = (s % nx + g.uniform()) / nx;
+                uv[2 * k + 1] = (s / nx + g.uniform()) / ny;
+            }
+            break;
+        }
+        case kind::sobol: {
+            std::uint32_t semente = std::uint32_t(h) ^ std::uint32_t(h >> 32);
+            std::uint32_t s0 = hash(semente), s1 = hash(semente + 1), s2 = hash(semente + 2);
+            for (int k = 0; k < n; ++k) {
+                std::uint32_t i = owen_scramble(std::uint32_t(first + k), s0);
+                uv[2 * k] = to_unit(owen_scramble(reverse_bits(i), s1));
+                uv[2 * k + 1] = to_unit(owen_scramble(sobol_dim1(i), s2));
+            }
+            break;
+        }
+        case kind::blue_noise: {
+            const blue_noise& m = blue_noise_mask();
+            int ox = int(h & 63), oy = int((h >> 6) & 63);
+            double bu = m.value(c + ox, l + oy), bv = m.value(c + ox + 32, l + oy + 17);
+            const double a1 = 0.7548776662466927, a2 = 0.5698402909980532;
+            for (int k = 0; k < n; ++k) {
+                uv[2 * k] = frac(bu + a1 * (first + k));
+                uv[2 * k + 1] = frac(bv + a2 * (first + k));
+            }
+            break;
+        }
+        default:
+            for (int k = 0; k < n; ++k) {
+                rng g(h ^ (std::uint64_t(first + k) * 0xd1b54a32d192ed03ull));
+                uv[2 * k] = g.uniform();
+                uv[2 * k + 1] = g.uniform();
+            }
+            break;
+        }
+    }
+
+    static const char* name(kind k) {
+        switch (k) {
+        case kind::stratified: return "estratificado";
+        case kind::sobol: return "sobol";
+        case kind::blue_noise: return "ruido-azul";
+        default: return "independente";
+        }
+    }
+
+    // nome da linha de comando -> tipo; nome desconhecido lança
+    // std::invalid_argument com os nomes aceitos
+    static kind parse(const std::string& nome) {
+        for (kind k : {kind::independent, kind::stratified, kind::sobol, kind::blue_noise})
+            if (nome == name(k)) return k;
+        throw std::invalid_argument("--amostrador desconhecido: '" + nome +
+                                    "' (independente, estratificado, sobol, ruido-azul)");
+    }
+
+  private:
+    kind tipo;
+    int spp;
+    std::uint64_t seed;
+    int nx, ny;
+
+    static double to_unit(std::uint32_t x) { return x * (1.0 / 4294967296.0); }
+    static double frac(double x) { return x - std::floor(x); }
+
+    static std::uint32_t reverse_bits(std::uint32_t x) {
+        x = (x << 16) | (x >> 16);
+        x = ((x & 0x00ff00ffu) << 8) | ((x & 0xff00ff00u) >> 8);
+        x = ((x & 0x0f0f0f0fu) << 4) | ((x & 0xf0f0f0f0u) >> 4);
+        x = ((x & 0x33333333u) << 2) | ((x & 0xccccccccu) >> 2);
+        x = ((x & 0x55555555u) << 1) | ((x & 0xaaaaaaaau) >> 1);
+        return x;
+    }
+
+    // segundo eixo de Sobol, já com os bits no sentido de 0.b1b2b3...
+    static std::uint32_t sobol_dim1(std::uint32_t i) {
+        std::uint32_t r = 0;
+        for (std::uint32_t v = 1u << 31; i; i >>= 1, v ^= v >> 1)
+            if (i & 1) r ^= v;
+        return r;
+    }
+
+    static std::uint32_t hash(std::uint32_t x) {
+        x ^= x >> 16;
+        x *= 0x7feb352du;
+        x ^= x >> 15;
+        x *= 0x846ca68bu;
+        x ^= x >> 16;
+        return x;
+    }
+
+    // embaralhamento de Owen: permutação de Laine-Karras sobre os bits
+    // invertidos (cada bit só depende dos bits mais significativos)
+    static std::uint32_t owen_scramble(std::uint32_t x, std::uint32_t s) {
+        x = reverse_bits(x);
+        x += s;
+        x ^= x * 0x6c50b47cu;
+        x ^= x * 0xb82f1e52u;
+        x ^= x * 0xc7afe638u;
+        x ^= x * 0x8d22f6e6u;
+        return reverse_bits(x);
+    }
+
+    // permutação de [0, n) escolhida por s (Kensler, "correlated
+    // multi-jittered sampling")
+    static std::uint32_t permute(std::uint32_t i, std::uint32_t n, std::uint32_t s) {
+        std::uint32_t w = n - 1;
+        w |= w >> 1; w |= w >> 2; w |= w >> 4; w |= w >> 8; w |= w >> 16;
+        do {
+            i ^= s; i *= 0xe170893du;
+            i ^= s >> 16; i ^= (i & w) >> 4;
+            i ^= s >> 8; i *= 0x0929eb3fu;
+            i ^= s >> 23; i ^= (i & w) >> 1;
+            i *= 1 | s >> 27; i *= 0x6935fa69u;
+            i ^= (i & w) >> 11; i *= 0x74dcb303u;
+            i ^= (i & w) >> 2; i *= 0x9e501cc3u;
+            i ^= (i & w) >> 2; i *= 0xc860a3dfu;
+            i &= w;
+            i ^= i >> 5;
+        } while (i >= n);
+        return (i + s) % n;
+    }
+};
+
+#endif
@@ -0,0 +1,384 @@
+#ifndef BAKED_H
+#define BAKED_H
+
+#include "../colors/color.h"
+#include "../ray/ray.h"
+#include "../vectors/vec3.h"
+
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <limits>
+#include <utility>
+
+/**
+ * cenário "assado" em tempo de compilação
+ *
+ * para um cenário fixo, os objetos ficam em arrays constexpr, um por
+ * tipo (esferas, cilindros, cones, planos), e tudo o que os
+ * construtores das classes calculam (eixo unitário, topo do cilindro,
+ * vértice e cos²θ do cone) já sai pronto do compilador.
+ *
+ * o cenário é um tipo com membros estáticos constexpr:
+ *
+ *   struct meu_cenario {
+ *       static constexpr std::array<baked_material, M> materials = ...;
+ *       static constexpr std::array<baked_sphere, S> spheres = ...;
+ *       static constexpr std::array<baked_cylinder, C> cylinders = ...;
+ *       static constexpr std::array<baked_cone, K> cones = ...;
+ *       static constexpr std::array<baked_plane, P> planes = ...;
+ *       static constexpr std::array<baked_light, L> lights = ...;
+ *       static constexpr color ambient = ...;
+ *   };
+ *
+ * e baked<meu_cenario>::hit / hit_any testam os objetos desenrolados
+ * por tipo, sem funções virtuais, sem bvh e sem heap (nem shared_ptr
+ * no registro de interseção). as contas são as mesmas das classes,
+ * na mesma ordem, então a imagem sai idêntica.
+ */
+
+// raiz quadrada em tempo de compilação (std::sqrt não é constexpr):
+// newton até parar de descer, depois o vizinho de menor resíduo
+// c² - a, calculado sem erro de arredondamento (divisão de veltkamp);
+// dá o mesmo valor arredondado que std::sqrt
+constexpr double sqrt_residuo(double c, double a) {
+    double p = c * c;
+    double s = c * 134217729.0;
+    double hi = s - (s - c);
+    double lo = c - hi;
+    return (p - a) + (((hi * hi - p) + 2 * hi * lo) + lo * lo);
+}
+
+constexpr double sqrt_c(double a) {
+    if (!(a > 0)) return a == 0 ? 0.0 : std::numeric_limits<double>::quiet_NaN();
+    double x = a < 1 ? 1.0 : a;
+    for (;;) {
+        double y = 0.5 * (x + a / x);
+        if (y >= x) break;
+        x = y;
+    }
+    double u = 1.0;
+    while (u * 2 <= x) u *= 2;
+    while (u > x) u /= 2;
+    double ulp = u * 0x1p-52;
+
+    double melhor = x;
+    double r = sqrt_residuo(x, a);
+    for (double c : {x - ulp, x + ulp}) {
+        double rc = sqrt_residuo(c, a);
+        if ((rc < 0 ? -rc : rc) < (r < 0 ? -r : r)) {
+            melhor = c;
+            r = rc;
+        }
+    }
+    return melhor;
+}
+
+constexpr vec3 unit_vector_c(const vec3& v) {
+    return v / sqrt_c(v.length_squared());
+}
+
+struct baked_material {
+    color k_ambient;
+    color k_diffuse;
+    color k_specular;
+    int shininess;
+
+    constexpr bool specular() const {
+        return k_specular.x() > 0 || k_specular.y() > 0 || k_specular.z() > 0;
+    }
+};
+
+// registro de interseção sem ponteiros: o material é um índice
+struct baked_hit {
+    point3 p;
+    vec3 normal;
+    double t;
+    int mat;
+};
+
+struct baked_light {
+    point3 position;
+    color intensity;
+};
+
+struct baked_sphere {
+    point3 center;
+    double radius;
+    int mat;
+
+    bool hit(const ray& r, double ray_tmin, double ray_tmax, baked_hit& rec) const {
+        vec3 oc = center - r.origin();
+        auto a = r.direction().length_squared();
+        auto h = dot(r.direction(), oc);
+        auto c = oc.length_squared() - radius*radius;
+        auto discriminant = h*h - a*c;
+        if (discriminant < 0) return false;
+
+        auto sqrtd = std::sqrt(discriminant);
+        divide_by sobre_a(a);
+        auto root = sobre_a(h - sqrtd);
+        if (root <= ray_tmin || ray_tmax <= root) {
+            root = sobre_a(h + sqrtd);
+            if (root <= ray_tmin || ray_tmax <= root)
+                return false;
+        }
+
+        rec.t = root;
+        rec.p = r.at(rec.t);
+        rec.normal = (rec.p - center) / radius;
+        rec.mat = mat;
+        return true;
+    }
+};
+
+// disco de centro c e normal n (fundo/tampa do cilindro, base do cone)
+inline bool baked_disc(const ray& r, const point3& c, const vec3& normal, double raio,
+                       double ray_tmin, double closest_t, double& t_out, point3& p_out) {
+    double denominador = dot(r.direction(), normal);
+    if (fabs(denominador) < 1e-12) return false;
+    double t = dot(c - r.origin(), normal) / denominador;
+    if (t <= ray_tmin || t >= closest_t) return false;
+    point3 p = r.at(t);
+    if ((p - c).length_squared() > raio*raio) return false;
+    t_out = t;
+    p_out = p;
+    return true;
+}
+
+struct baked_cylinder {
+    point3 centroBase;
+    double h;
+    double raio;
+    bool fundo;
+    bool tampa;
+    vec3 u;
+    point3 centroTopo;
+    int mat;
+
+    // mesmos argumentos do construtor de cilindro
+    static constexpr baked_cylinder make(const point3& base, const vec3& dir, double h, double raio,
+                                         bool fundo, bool tampa, int mat) {
+        vec3 u = unit_vector_c(dir);
+        return {base, h, raio, fundo, tampa, u, base + u*h, mat};
+    }
+
+    bool hit(const ray& r, double ray_tmin, double ray_tmax, baked_hit& rec) const {
+        bool hit_anything = false;
+        double closest_t = ray_tmax;
+        double t;
+        point3 p;
+
+        if (fundo && baked_disc(r, centroBase, -u, raio, ray_tmin, closest_t, t, p)) {
+            hit_anything = true;
+            closest_t = rec.t = t;
+            rec.p = p;
+            rec.normal = -u;
+        }
+        if (tampa && baked_disc(r, centroTopo, u, raio, ray_tmin, closest_t, t, p)) {
+            hit_anything = true;
+            closest_t = rec.t = t;
+            rec.p = p;
+            rec.normal = u;
+        }
+
+        // corpo
+        vec3 d = r.direction();
+        vec3 deltaP = r.origin() - centroBase;
+        vec3 w = d - dot(d, u)*u;
+        vec3 v = deltaP - dot(deltaP, u)*u;
+        double a = dot(w,w);
+        double b = 2*dot(v,w);
+        double c = dot(v,v) - raio*raio;
+        auto delta = b*b-4*a*c;
+        if (delta >= 0 && fabs(a) >= 1e-12) {
+            auto sqrtd = std::sqrt(delta);
+            divide_by sobre_2a(2*a);
+            double raizes[] = {sobre_2a(-b - sqrtd), sobre_2a(-b + sqrtd)};
+            for (double tx : raizes) {
+                if (tx <= ray_tmin || tx >= closest_t) continue;
+                point3 px = r.at(tx);
+                double altura = dot(px - centroBase, u);
+                if (altura < 0 || altura > h) continue;
+                closest_t = tx;
+                hit_anything = true;
+                rec.t = tx;
+                rec.p = px;
+                rec.normal = unit_vector((px - centroBase) - dot(px - centroBase, u) * u);
+            }
+        }
+
+        if (hit_anything) rec.mat = mat;
+        return hit_anything;
+    }
+};
+
+struct baked_cone {
+    point3 centroBase;
+    double h;
+    double raio;
+    bool tem_base;
+    vec3 u;
+    point3 vertice;
+    double cos2_theta;
+    int mat;
+
+    // mesmos argumentos do construtor de cone
+    static constexpr baked_cone make(const point3& base, const vec3& dir, double h, double raio,
+                                     bool tem_base, int mat) {
+        vec3 u = unit_vector_c(dir);
+        return {base, h, raio, tem_base, u, base + u*h, (h*h) / (h*h + raio*raio), mat};
+    }
+
+    bool hit(const ray& r, double ray_tmin, double ray_tmax, baked_hit& rec) const {
+        bool hit_anything = false;
+        double closest_t = ray_tmax;
+        double t;
+        point3 p;
+
+        if (tem_base && baked_disc(r, centroBase, -u, raio, ray_tmin, closest_t, t, p)) {
+            hit_anything = true;
+            closest_t = rec.t = t;
+            rec.p = p;
+            rec.normal = -u;
+        }
+
+        // corpo
+        vec3 d = r.direction();
+        const vec3& n = u;
+        double c2 = cos2_theta;
+        vec3 v = vertice - r.origin();
+        double dn = dot(d, n);
+        double dd = dot(d, d);
+        double vn = dot(v, n);
+        double vd = dot(v, d);
+        double vv = dot(v, v);
+
+        double a = dn*dn - dd*c2;
+        double b = vd*c2 - vn*dn;
+        double c = vn*vn - vv*c2;
+        double delta = b*b - a*c;
+        if (fabs(a) >= 1e-12 && delta >= 0.0) {
+            double sqrtd = std::sqrt(delta);
+            divide_by sobre_a(a);
+            double raizes[] = {sobre_a(-b - sqrtd), sobre_a(-b + sqrtd)};
+            for (double tx : raizes) {
+                if (tx <= ray_tmin || tx >= closest_t) continue;
+                point3 P = r.at(tx);
+                double proj = dot(vertice - P, n);
+                if (proj < 0.0 || proj > h) continue;
+                vec3 w = P - vertice;
+                vec3 grad = ((dot(w, n)) * n) - c2 * w;
+                double len = grad.length();
+                if (len < 1e-12) continue;
+                vec3 normal = grad / len;
+                if (dot(r.direction(), normal) > 0)
+                    normal = -normal;
+                closest_t = tx;
+                hit_anything = true;
+                rec.t = tx;
+                rec.p = P;
+                rec.normal = normal;
+            }
+        }
+
+        if (hit_anything) rec.mat = mat;
+        return hit_anything;
+    }
+};
+
+struct baked_plane {
+    point3 point_on_plane;
+    vec3 normal;
+    int mat;
+    // bit k ligado: o plano pode fazer sombra para a luz k
+    unsigned occludes;
+
+    // occludes é preenchido por baked_occlusion_mask
+    static constexpr baked_plane make(const point3& p, const vec3& n, int mat) {
+        return {p, unit_vector_c(n), mat, ~0u};
+    }
+
+    bool hit(const ray& r, double ray_tmin, double ray_tmax, baked_hit& rec) const {
+        double denominator = dot(normal, r.direction());
+        if (std::abs(denominator) < 1e-8) return false;
+
+        double t = dot(point_on_plane - r.origin(), normal) / denominator;
+        if (t <= ray_tmin || t > ray_tmax) return false;
+
+        rec.t = t;
+        rec.p = r.at(t);
+        rec.mat = mat;
+        rec.normal = denominator > 0.0 ? -normal : normal;
+        return true;
+    }
+};
+
+// o mesmo critério de scene::plane_occludes, com uma luz pontual e um
+// olho: o plano só faz sombra se olho e luz não estão do mesmo lado
+constexpr bool baked_plane_occludes(const baked_plane& pl, const point3& luz, const point3& olho) {
+    const double eps = 1e-6;
+    double lado = dot(olho - pl.point_on_plane, pl.normal) > 0.0 ? 1.0 : -1.0;
+    return lado * dot(olho - pl.point_on_plane, pl.normal) <= eps
+        || lado * dot(luz - pl.point_on_plane, pl.normal) <= eps;
+}
+
+template <std::size_t N, std::size_t L>
+constexpr std::array<baked_plane, N> baked_occlusion_mask(std::array<baked_plane, N> planos,
+                                                          const std::array<baked_light, L>& luzes,
+                                                          const point3& olho) {
+    for (std::size_t i = 0; i < N; ++i) {
+        unsigned mask = 0;
+        for (std::size_t k = 0; k < L; ++k)
+            if (baked_plane_occludes(planos[i], luzes[k].position, olho)) mask |= 1u << k;
+        planos[i].occludes = mask;
+    }
+    return planos;
+}
+
+// chama f(arr[0]), f(arr[1]), ... sem laço
+template <class T, std::size_t N, class F, std::size_t... I>
+inline void baked_each(const std::array<T, N>& arr, F&& f, std::index_sequence<I...>) {
+    (f(arr[I]), ...);
+}
+
+// idem, parando no primeiro f que devolve true
+template <class T, std::size_t N, class F, std::size_t... I>
+inline bool baked_any(const std::array<T, N>& arr, F&& f, std::index_sequence<I...>) {
+    return (f(arr[I]) || ...);
+}
+
+template <class Cena>
+struct baked {
+    // interseção mais próxima em (tmin, tmax)
+    static bool hit(const ray& r, double tmin, double tmax, baked_hit& rec) {
+        bool acertou = false;
+        auto testa = [&](const auto& obj) {
+            if (obj.hit(r, tmin, tmax, rec)) {
+                acertou = true;
+                tmax = rec.t;
+            }
+        };
+        baked_each(Cena::spheres, testa, std::make_index_sequence<Cena::spheres.size()>());
+        baked_each(Cena::cylinders, testa, std::make_index_sequence<Cena::cylinders.size()>());
+        baked_each(Cena::cones, testa, std::make_index_sequence<Cena::cones.size()>());
+        baked_each(Cena::planes, testa, std::make_index_sequence<Cena::planes.size()>());
+        return acertou;
+    }
+
+    // raio de sombra para a luz k: qualquer interseção serve; os planos
+    // que não fazem sombra para essa luz ficam de fora
+    static bool hit_any(const ray& r, double tmin, double tmax, std::size_t k) {
+        baked_hit rec;
+        auto testa = [&](const auto& obj) { return obj.hit(r, tmin, tmax, rec); };
+        auto testa_plano = [&](const baked_plane& pl) {
+            return ((pl.occludes >> k) & 1u) && pl.hit(r, tmin, tmax, rec);
+        };
+        return baked_any(Cena::spheres, testa, std::make_index_sequence<Cena::spheres.size()>())
+            || baked_any(Cena::cylinders, testa, std::make_index_sequence<Cena::cylinders.size()>())
+            || baked_any(Cena::cones, testa, std::make_index_sequence<Cena::cones.size()>())
+            || baked_any(Cena::planes, testa_plano, std::make_index_sequence<Cena::planes.size()>());
+    }
+};
+
+#endif
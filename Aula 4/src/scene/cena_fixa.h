@@ -0,0 +1,61 @@
+#ifndef CENA_FIXA_H
+#define CENA_FIXA_H
+
+#include "baked.h"
+
+/**
+ * o cenário padrão (montar_cena em main.cpp) assado em tempo de
+ * compilação para baked<cena_fixa>; mudar um deve mudar o outro
+ *
+ * os planos que não fazem sombra são decididos aqui mesmo, para o
+ * olho da câmera padrão na origem
+ */
+struct cena_fixa {
+    static constexpr double R_esfera = 40.0;
+    static constexpr point3 C_esfera = point3(0, 0, -100);
+    static constexpr vec3 dr = vec3(-1.0/sqrt_c(3.0), 1.0/sqrt_c(3.0), -1.0/sqrt_c(3.0));
+    static constexpr point3 topo_cilindro = C_esfera + unit_vector_c(dr) * (3 * R_esfera);
+    static constexpr point3 olho = point3(0, 0, 0);
+
+    enum { esfera, cilindro, cone, chao, fundo };
+
+    static constexpr std::array<baked_material, 5> materials = {{
+        {color(0.7, 0.2, 0.2), color(0.7, 0.2, 0.2), color(0.7, 0.2, 0.2), 10},
+        {color(0.2, 0.3, 0.8), color(0.2, 0.3, 0.8), color(0.2, 0.3, 0.8), 10},
+        {color(0.8, 0.3, 0.2), color(0.8, 0.3, 0.2), color(0.8, 0.3, 0.2), 10},
+        {color(0.2, 0.7, 0.2), color(0.2, 0.7, 0.2), color(0.0, 0.0, 0.0), 1},
+        {color(0.3, 0.3, 0.7), color(0.3, 0.3, 0.7), color(0.0, 0.0, 0.0), 1},
+    }};
+
+    static constexpr std::array<baked_light, 1> lights = {{
+        {point3(0, 60, -30), color(0.7, 0.7, 0.7)},
+    }};
+
+    static constexpr color ambient = color(0.3, 0.3, 0.3);
+
+    static constexpr std::array<baked_sphere, 1> spheres = {{
+        {C_esfera, R_esfera, esfera},
+    }};
+
+    static constexpr std::array<baked_cylinder, 1> cylinders = {{
+        baked_cylinder::make(C_esfera, dr, 3 * R_esfera, R_esfera / 3.0, true, true, cilindro),
+    }};
+
+    // como em montar_cena: raio_base_cone e altura_cone vão, nessa ordem,
+    // para os parâmetros (h, raio) do construtor
+    static constexpr std::array<baked_cone, 1> cones = {{
+        baked_cone::make(topo_cilindro, dr, 1.5 * R_esfera, 1.5 * R_esfera / 3.0, true, cone),
+    }};
+
+    static constexpr std::array<baked_plane, 2> planes = baked_occlusion_mask(std::array<baked_plane, 2>{{
+        baked_plane::make(point3(0, -R_esfera, 0), vec3(0, 1, 0), chao),
+        baked_plane::make(point3(0, 0, -200), vec3(0, 0, 1), fundo),
+    }}, lights, olho);
+};
+
+// com o olho e a luz acima do chão e na frente do fundo, nenhum
+// plano entra nos raios de sombra
+static_assert(cena_fixa::planes[0].occludes == 0 && cena_fixa::planes[1].occludes == 0,
+              "planos do cenário fixo não deveriam fazer sombra");
+
+#endif
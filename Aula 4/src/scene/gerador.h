@@ -0,0 +1,95 @@
+#ifndef GERADOR_H
+#define GERADOR_H
+
+#include "../colors/color.h"
+#include "../material/material.h"
+#include "../objects/sphere.h"
+#include "../objects/cilindro.h"
+#include "../objects/cone.h"
+#include "../objects/plano.h"
+#include "../util/rng.h"
+#include "scene.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+/**
+ * cenário procedural no estilo da "cena final" do livro:
+ * n objetos (esferas, cilindros e cones) espalhados em uma grade
+ * com jitter sobre o mesmo chão do main(), de frente para o olho.
+ * a área cresce com n, então a densidade de objetos é constante.
+ *
+ * a mesma (n, semente) gera sempre o mesmo cenário. a luz é a mesma
+ * do main(); o cenário volta sem build().
+ */
+inline scene gerar_cena(std::size_t n, std::uint64_t seed) {
+    rng g(seed);
+    scene cena;
+    hittable_list& mundo = cena.objects;
+    cena.lights.push_back(light::point(point3(0, 60, -30), color(0.7, 0.7, 0.7)));
+
+    const double y_chao = -40.0;
+    auto mat_chao = std::make_shared<material>(
+        color(0.2, 0.7, 0.2), color(0.2, 0.7, 0.2), color(0.0, 0.0, 0.0), 1);
+    mundo.add(std::make_shared<plane>(point3(0, y_chao, 0), vec3(0, 1, 0), mat_chao));
+
+    // paleta de materiais compartilhada pelos objetos
+    std::size_t n_mat = std::min<std::size_t>(std::max<std::size_t>(n, 1), 64);
+    std::vector<std::shared_ptr<material>> paleta;
+    for (std::size_t i = 0; i < n_mat; ++i) {
+        color kd(g.uniform(0.1, 0.9), g.uniform(0.1, 0.9), g.uniform(0.1, 0.9));
+        bool brilhante = g.uniform() < 0.5;
+        color ks = brilhante ? color(0.6, 0.6, 0.6) : color(0, 0, 0);
+        int m = brilhante ? 5 + int(g.uniform(0, 60)) : 1;
+        paleta.push_back(std::make_shared<material>(kd, kd, ks, m));
+    }
+
+    // espelhos e vidros: só k_reflect, k_transmit e ior, que o Phong não
+    // lê. gerador à parte, para os objetos e as cores do Phong continuarem
+    // os mesmos para cada semente
+    rng g_mat(seed ^ 0x6d6174657269616cull);
+    for (auto& mat : paleta) {
+        double t = g_mat.uniform();
+        if (t < 0.2) {
+            mat->k_reflect = color(0.8, 0.8, 0.8);
+        } else if (t < 0.3) {
+            mat->k_transmit = color(0.95, 0.95, 0.95);
+            mat->ior = 1.5;
+        }
+    }
+
+    // grade k x k de células, a primeira linha começa em z = -60
+    const double celula = 6.0;
+    std::size_t k = std::size_t(std::ceil(std::sqrt(double(n))));
+    double x0 = -0.5 * k * celula;
+    double z0 = -60.0;
+
+    for (std::size_t i = 0; i < n; ++i) {
+        double cx = x0 + (i % k + g.uniform(0.2, 0.8)) * celula;
+        double cz = z0 - (i / k + g.uniform(0.2, 0.8)) * celula;
+        double r = celula * g.uniform(0.12, 0.3);
+        auto mat = paleta[std::size_t(g.uniform() * n_mat)];
+
+        double tipo = g.uniform();
+        if (tipo < 0.5) {
+            mundo.add(std::make_shared<sphere>(point3(cx, y_chao + r, cz), r, mat));
+        } else if (tipo < 0.75) {
+            // cilindro em pé, levemente inclinado
+            vec3 eixo(g.uniform(-0.3, 0.3), 1.0, g.uniform(-0.3, 0.3));
+            double h = r * g.uniform(1.5, 4.0);
+            mundo.add(std::make_shared<cilindro>(
+                point3(cx, y_chao, cz), eixo, h, 0.6 * r, true, true, mat));
+        } else {
+            double h = r * g.uniform(1.5, 3.5);
+            mundo.add(std::make_shared<cone>(
+                point3(cx, y_chao, cz), vec3(0, 1, 0), h, r, true, mat));
+        }
+    }
+
+    return cena;
+}
+
+#endif
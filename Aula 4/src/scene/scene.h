@@ -0,0 +1,107 @@
+#ifndef SCENE_H
+#define SCENE_H
+
+#include "../accel/bvh.h"
+#include "../colors/color.h"
+#include "../lights/light.h"
+#include "../objects/hittable_list.h"
+#include "../objects/plano.h"
+#include "../render/irradiance_cache.h"
+
+#include <algorithm>
+#include <memory>
+#include <vector>
+
+/**
+ * cenário completo: objetos, luzes e as estruturas de aceleração
+ *
+ * build() monta o bvh do mundo e, para cada luz, a estrutura que os
+ * raios de sombra testam. ficam de fora dela:
+ * - objetos com casts_shadows = false;
+ * - objetos fora da lista de light linking da luz (se houver lista);
+ * - planos que nunca fazem sombra para essa luz (ver plane_occludes).
+ * se nada ficou de fora, a luz usa o próprio bvh do mundo.
+ */
+class scene {
+  public:
+    hittable_list objects;
+    std::vector<light> lights;
+    color ambient = color(0.3, 0.3, 0.3);
+    // cor dos raios primários que não atingem nada
+    color background = color(0, 0, 0);
+    std::shared_ptr<bvh> world;
+    // se presente, o termo ambiente é multiplicado pela oclusão ambiente
+    // (e somado à luz indireta) interpolada deste cache
+    std::shared_ptr<const irradiance_cache> indirect;
+
+    // olhos: posições de onde saem os raios primários (uma por câmera)
+    void build(const std::vector<point3>& olhos) {
+        world = std::make_shared<bvh>(objects);
+        occluders.clear();
+        for (auto& luz : lights) {
+            std::vector<std::shared_ptr<hittable>> candidatos;
+            for (const auto& obj : objects.objects)
+                if (casts_for(*obj, luz, olhos)) candidatos.push_back(obj);
+
+            if (candidatos.size() == objects.objects.size()) {
+                luz.occluders = world;
+            } else {
+                auto b = std::make_shared<bvh>(candidatos);
+                occluders.push_back(b);
+                luz.occluders = b;
+            }
+        }
+    }
+
+    void build(const point3& olho) { build(std::vector<point3>{olho}); }
+
+    // depois de mover objetos: atualiza o mundo e as estruturas das luzes
+    void update() {
+        world->update();
+        for (auto& b : occluders) b->update();
+    }
+
+    /**
+     * um plano infinito pode fazer sombra para a luz?
+     *
+     * todo ponto sombreado é alcançado por um caminho que sai de um olho.
+     * se todos os olhos estão do mesmo lado do plano, nenhum raio cruza
+     * para o outro lado sem atingir o plano antes, então os pontos
+     * sombreados ficam desse lado. com a luz estritamente do mesmo lado,
+     * o segmento ponto -> luz fica todo no semiespaço (convexo) e não
+     * cruza o plano. para luzes de área vale o mesmo com todos os cantos
+     * da caixa da luz.
+     */
+    static bool plane_occludes(const plane& p, const aabb& luz, const std::vector<point3>& olhos) {
+        if (olhos.empty()) return true;
+        const double eps = 1e-6;
+        double lado = dot(olhos.front() - p.get_point(), p.get_normal()) > 0.0 ? 1.0 : -1.0;
+        for (const point3& o : olhos)
+            if (lado * dot(o - p.get_point(), p.get_normal()) <= eps) return true;
+        for (int k = 0; k < 8; ++k) {
+            point3 canto((k & 1) ? luz.pmax.x() : luz.pmin.x(),
+                         (k & 2) ? luz.pmax.y() : luz.pmin.y(),
+                         (k & 4) ? luz.pmax.z() : luz.pmin.z());
+            if (lado * dot(canto - p.get_point(), p.get_normal()) <= eps) return true;
+        }
+        return false;
+    }
+
+  private:
+    // bvhs de oclusão próprios das luzes (os que não são o mundo)
+    std::vector<std::shared_ptr<bvh>> occluders;
+
+    static bool casts_for(const hittable& obj, const light& luz, const std::vector<point3>& olhos) {
+        if (!obj.casts_shadows) return false;
+        if (!luz.linked.empty()) {
+            bool ligado = std::any_of(luz.linked.begin(), luz.linked.end(),
+                                      [&](const std::shared_ptr<hittable>& o) { return o.get() == &obj; });
+            if (!ligado) return false;
+        }
+        if (auto p = dynamic_cast<const plane*>(&obj))
+            return plane_occludes(*p, luz.bounding_box(), olhos);
+        return true;
+    }
+};
+
+#endif
@@ -0,0 +1,89 @@
+#ifndef ARGS_H
+#define ARGS_H
+
+#include <cstdint>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+/**
+ * leitura simples da linha de comando
+ * opções no formato "--nome valor" ou só "--nome"
+ *
+ * nos valores numéricos, uma opção sem valor (fim da linha ou outra
+ * opção logo depois) fica com o padrão; um valor que não é número
+ * lança std::invalid_argument com uma mensagem para o usuário
+ */
+class args {
+  public:
+    args(int argc, char* argv[]) : lista(argv + 1, argv + argc) {}
+
+    // opções já separadas (p.ex. as de um pedido ao servidor)
+    explicit args(std::vector<std::string> opcoes) : lista(std::move(opcoes)) {}
+
+    bool has(const std::string& nome) const {
+        for (const auto& a : lista)
+            if (a == nome) return true;
+        return false;
+    }
+
+    std::string get(const std::string& nome, const std::string& padrao = "") const {
+        for (size_t i = 0; i + 1 < lista.size(); ++i)
+            if (lista[i] == nome) return lista[i + 1];
+        return padrao;
+    }
+
+    double get_double(const std::string& nome, double padrao) const {
+        std::string v = get(nome);
+        return sem_valor(v) ? padrao : para_double(nome, v);
+    }
+
+    long long get_int(const std::string& nome, long long padrao) const {
+        std::string v = get(nome);
+        return sem_valor(v) ? padrao : para_int(nome, v);
+    }
+
+    // lista separada por vírgulas: "--n 10,100,1000"
+    std::vector<long long> get_list(const std::string& nome) const {
+        std::vector<long long> out;
+        std::stringstream ss(get(nome));
+        std::string item;
+        while (std::getline(ss, item, ','))
+            if (!item.empty()) out.push_back(para_int(nome, item));
+        return out;
+    }
+
+  private:
+    std::vector<std::string> lista;
+
+    static bool sem_valor(const std::string& v) { return v.empty() || v.rfind("--", 0) == 0; }
+
+    // o valor inteiro tem que ser o número (nada de sobras, como "10x")
+    static long long para_int(const std::string& nome, const std::string& v) {
+        size_t fim = 0;
+        try {
+            long long x = std::stoll(v, &fim);
+            if (fim == v.size()) return x;
+        } catch (const std::logic_error&) {
+        }
+        throw invalido(nome, v);
+    }
+
+    static double para_double(const std::string& nome, const std::string& v) {
+        size_t fim = 0;
+        try {
+            double x = std::stod(v, &fim);
+            if (fim == v.size()) return x;
+        } catch (const std::logic_error&) {
+        }
+        throw invalido(nome, v);
+    }
+
+    static std::invalid_argument invalido(const std::string& nome, const std::string& v) {
+        return std::invalid_argument(nome + " espera um número, recebeu '" + v + "'");
+    }
+};
+
+#endif
@@ -0,0 +1,29 @@
+#ifndef ARQUIVO_H
+#define ARQUIVO_H
+
+#include <cstdio>
+#include <fstream>
+#include <functional>
+#include <string>
+
+// escreve em 'caminho.tmp' e renomeia por cima de 'caminho'
+// quem lê o arquivo nunca vê uma versão pela metade
+inline bool write_file_atomic(const std::string& caminho,
+                              const std::function<void(std::ostream&)>& escrever,
+                              bool binario = false) {
+    std::string tmp = caminho + ".tmp";
+    {
+        std::ofstream out(tmp, binario ? std::ios::binary : std::ios::out);
+        if (!out) return false;
+        escrever(out);
+        out.flush();
+        if (!out) return false;
+    }
+#ifdef _WIN32
+    // no windows o rename não substitui um arquivo existente
+    std::remove(caminho.c_str());
+#endif
+    return std::rename(tmp.c_str(), caminho.c_str()) == 0;
+}
+
+#endif
@@ -0,0 +1,136 @@
+#ifndef FAST_MATH_H
+#define FAST_MATH_H
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+
+#if defined(__SSE__) || defined(__x86_64__)
+#include <xmmintrin.h>
+#define FAST_MATH_SSE 1
+#endif
+
+/**
+ * aproximações de erro limitado para as contas do caminho quente
+ *
+ * o modo rápido é escolhido na compilação:
+ *
+ *   g++ -std=c++17 -O2 -pthread -DFAST_MATH main.cpp -o rt_rapido
+ *
+ * e troca, via fast_math (constexpr):
+ *   - unit_vector: v * rsqrt(|v|²) no lugar de v / sqrt(|v|²);
+ *   - solvers de quádricas (esfera, cilindro, cone): um recíproco do
+ *     denominador e multiplicações (divide_by);
+ *   - Phong normalizado do path tracer: fast_pow no lugar de std::pow.
+ * o Phong de main já usa ipow (multiplicações), igual nos dois modos.
+ *
+ * conferência contra o build preciso (PSNR mínimo, ver --comparar):
+ *   ./rt > preciso.ppm; ./rt_rapido > rapido.ppm
+ *   ./rt --comparar preciso.ppm --com rapido.ppm --psnr-min 50
+ * conferir_fast_math.sh compila os dois e faz isso em vários cenários
+ */
+#ifdef FAST_MATH
+inline constexpr bool fast_math = true;
+#else
+inline constexpr bool fast_math = false;
+#endif
+
+/**
+ * 1/sqrt(x) para x normal em float (~1e-38 a ~3e38)
+ *
+ * estimativa do rsqrtss (erro relativo <= 1.5·2^-12) e dois passos de
+ * Newton y' = y (1.5 - x y²/2) em double. cada passo leva o erro e a
+ * ~1.5 e²: 3.7e-4 -> 2e-7 -> 6e-14. com o arredondamento das contas,
+ * o erro relativo fica abaixo de 1e-13 (~500 ulp de double), sem
+ * efeito visível em direções e normais.
+ */
+inline double rsqrt(double x) {
+#ifdef FAST_MATH_SSE
+    double y = _mm_cvtss_f32(_mm_rsqrt_ss(_mm_set_ss(float(x))));
+#else
+    double y = 1.0f / std::sqrt(float(x));
+#endif
+    double meio = 0.5 * x;
+    y = y * (1.5 - meio * y * y);
+    y = y * (1.5 - meio * y * y);
+    return y;
+}
+
+/**
+ * vários numeradores sobre o mesmo denominador
+ *
+ * no modo rápido, uma divisão e uma multiplicação por numerador: o
+ * erro vai de 0.5 ulp (divisão) para no máximo 1.5 ulp (recíproco
+ * arredondado e produto arredondado). no modo preciso, divide mesmo.
+ */
+class divide_by {
+  public:
+    explicit divide_by(double d) : d(d), inv(fast_math ? 1.0 / d : 0.0) {}
+
+    double operator()(double x) const {
+        if constexpr (fast_math) return x * inv;
+        return x / d;
+    }
+
+  private:
+    double d;
+    double inv;
+};
+
+/**
+ * pow aproximado para x em [0, 1] e expoente m >= 0: 2^(m log2 x)
+ *
+ * log2: expoente do float mais log da mantissa em [√½, √2) pela série
+ * de atanh até f^7 (truncamento < 3e-8). exp2: arredonda para o
+ * inteiro mais próximo e usa o polinômio de grau 6 do cephes para
+ * 2^f, f em [-½, ½] (erro relativo ~2e-7). com o arredondamento do
+ * float (inclusive de x), o erro relativo fica abaixo de 7e-7·(1 + m)
+ * (medido: 6.6e-6 com m = 10, 4.4e-5 com m = 1000), bem menos que um
+ * nível de 8 bits para os brilhos usados aqui. x = 0 dá ~1e-38.
+ */
+inline float fast_log2(float x) {
+    std::uint32_t bits;
+    std::memcpy(&bits, &x, sizeof bits);
+    float e = float(int((bits >> 23) & 255) - 127);
+    bits = (bits & 0x7fffffu) | 0x3f800000u;
+    float mm;
+    std::memcpy(&mm, &bits, sizeof mm);
+    if (mm > 1.41421356f) {
+        mm *= 0.5f;
+        e += 1.0f;
+    }
+    float f = (mm - 1.0f) / (mm + 1.0f);
+    float f2 = f * f;
+    float ln = 2.0f * f * (1.0f + f2 * (1.0f / 3 + f2 * (1.0f / 5 + f2 * (1.0f / 7))));
+    return e + ln * 1.44269504f;
+}
+
+inline float fast_exp2(float y) {
+    // arredondamento para o inteiro mais próximo (empates para longe
+    // do zero; o polinômio aceita f = ±½)
+    y = std::max(y, -126.0f);
+    float i = float(int(y < 0.0f ? y - 0.5f : y + 0.5f));
+    float f = y - i;
+    float p = ((((1.535336188e-4f * f + 1.339887440e-3f) * f + 9.618437357e-3f) * f
+               + 5.550332471e-2f) * f + 2.402264791e-1f) * f;
+    p = (p + 6.931472028e-1f) * f + 1.0f;
+    std::uint32_t bits = std::uint32_t(int(i) + 127) << 23;
+    float escala;
+    std::memcpy(&escala, &bits, sizeof escala);
+    return p * escala;
+}
+
+inline float fast_pow(float x, float m) {
+    return fast_exp2(m * fast_log2(x));
+}
+
+
+// o mesmo em double, com pow(0, m) exato (0, ou 1 para m = 0), para
+// os lóbulos especulares do path tracer; mesmo erro (conta em float)
+inline double fast_pow(double x, double m) {
+    if (x <= 0.0) return m == 0.0 ? 1.0 : 0.0;
+    return fast_pow(float(x), float(m));
+}
+
+#endif
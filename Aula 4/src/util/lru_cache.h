@@ -0,0 +1,55 @@
+#ifndef LRU_CACHE_H
+#define LRU_CACHE_H
+
+#include <cstddef>
+#include <list>
+#include <unordered_map>
+#include <utility>
+
+/**
+ * cache com no máximo 'capacity' entradas; ao passar disso, sai a
+ * usada há mais tempo. get() e put() marcam a entrada como recente.
+ * não é thread-safe: quem usa de várias threads protege com um mutex
+ */
+template <class K, class V>
+class lru_cache {
+  public:
+    explicit lru_cache(std::size_t capacity) : capacity(capacity ? capacity : 1) {}
+
+    // ponteiro para o valor (nulo se não houver); válido até o próximo put()
+    V* get(const K& chave) {
+        auto it = indice.find(chave);
+        if (it == indice.end()) return nullptr;
+        entradas.splice(entradas.begin(), entradas, it->second);
+        return &it->second->second;
+    }
+
+    V& put(const K& chave, V valor) {
+        auto it = indice.find(chave);
+        if (it != indice.end()) {
+            it->second->second = std::move(valor);
+            entradas.splice(entradas.begin(), entradas, it->second);
+            return it->second->second;
+        }
+        entradas.emplace_front(chave, std::move(valor));
+        indice[chave] = entradas.begin();
+        if (entradas.size() > capacity) {
+            indice.erase(entradas.back().first);
+            entradas.pop_back();
+            ++removidas;
+        }
+        return entradas.front().second;
+    }
+
+    std::size_t size() const { return entradas.size(); }
+    std::size_t evictions() const { return removidas; }
+
+  private:
+    std::size_t capacity;
+    std::size_t removidas = 0;
+    // da mais recente para a mais antiga
+    std::list<std::pair<K, V>> entradas;
+    std::unordered_map<K, typename std::list<std::pair<K, V>>::iterator> indice;
+};
+
+#endif
@@ -0,0 +1,53 @@
+#ifndef RNG_H
+#define RNG_H
+
+#include <cstdint>
+#include <cstring>
+
+// gerador pseudoaleatório pequeno e reprodutível (splitmix64)
+// a mesma semente gera a mesma sequência em qualquer plataforma,
+// o que não é garantido pelas distribuições de <random>
+class rng {
+  public:
+    explicit rng(std::uint64_t seed) : state(seed) {}
+
+    std::uint64_t next() {
+        std::uint64_t z = (state += 0x9e3779b97f4a7c15ull);
+        z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+        z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+        return z ^ (z >> 31);
+    }
+
+    // [0, 1)
+    double uniform() { return (next() >> 11) * (1.0 / 9007199254740992.0); }
+
+    // [a, b)
+    double uniform(double a, double b) { return a + (b - a) * uniform(); }
+
+  private:
+    std::uint64_t state;
+};
+
+// mistura (c, l, amostra, semente) em uma semente independente,
+// para que a sequência de um pixel não dependa da ordem dos tiles
+// nem da quantidade de threads
+inline std::uint64_t pixel_seed(int c, int l, int amostra, std::uint64_t seed = 0) {
+    rng g(seed ^ (std::uint64_t(std::uint32_t(l)) << 32 | std::uint32_t(c)));
+    g.next();
+    return g.next() ^ (std::uint64_t(amostra) * 0xd1b54a32d192ed03ull);
+}
+
+// semente a partir de um ponto do espaço (bits exatos das coordenadas),
+// para amostrar algo no ponto sem saber de qual pixel ele veio
+inline std::uint64_t point_seed(double x, double y, double z) {
+    std::uint64_t b[3];
+    std::memcpy(&b[0], &x, sizeof(double));
+    std::memcpy(&b[1], &y, sizeof(double));
+    std::memcpy(&b[2], &z, sizeof(double));
+    rng g(b[0]);
+    std::uint64_t h = g.next() ^ b[1];
+    rng g2(h);
+    return g2.next() ^ b[2];
+}
+
+#endif
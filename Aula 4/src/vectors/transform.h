@@ -0,0 +1,118 @@
+#ifndef TRANSFORM_H
+#define TRANSFORM_H
+
+#include "vec3.h"
+#include <cmath>
+
+// matriz 3x3 (linhas), usada para a parte linear das transformações afins
+class mat3 {
+  public:
+    double m[3][3];
+
+    mat3() : m{{1,0,0},{0,1,0},{0,0,1}} {}
+
+    vec3 operator*(const vec3& v) const {
+        return vec3(
+            m[0][0]*v.x() + m[0][1]*v.y() + m[0][2]*v.z(),
+            m[1][0]*v.x() + m[1][1]*v.y() + m[1][2]*v.z(),
+            m[2][0]*v.x() + m[2][1]*v.y() + m[2][2]*v.z()
+        );
+    }
+
+    mat3 operator*(const mat3& b) const {
+        mat3 r;
+        for (int i = 0; i < 3; ++i)
+            for (int j = 0; j < 3; ++j)
+                r.m[i][j] = m[i][0]*b.m[0][j] + m[i][1]*b.m[1][j] + m[i][2]*b.m[2][j];
+        return r;
+    }
+
+    mat3 transposta() const {
+        mat3 r;
+        for (int i = 0; i < 3; ++i)
+            for (int j = 0; j < 3; ++j)
+                r.m[i][j] = m[j][i];
+        return r;
+    }
+
+    // inversa pela matriz adjunta
+    mat3 inversa() const {
+        mat3 r;
+        double det = m[0][0]*(m[1][1]*m[2][2] - m[1][2]*m[2][1])
+                   - m[0][1]*(m[1][0]*m[2][2] - m[1][2]*m[2][0])
+                   + m[0][2]*(m[1][0]*m[2][1] - m[1][1]*m[2][0]);
+        double inv = 1.0 / det;
+
+        r.m[0][0] =  (m[1][1]*m[2][2] - m[1][2]*m[2][1]) * inv;
+        r.m[0][1] = -(m[0][1]*m[2][2] - m[0][2]*m[2][1]) * inv;
+        r.m[0][2] =  (m[0][1]*m[1][2] - m[0][2]*m[1][1]) * inv;
+        r.m[1][0] = -(m[1][0]*m[2][2] - m[1][2]*m[2][0]) * inv;
+        r.m[1][1] =  (m[0][0]*m[2][2] - m[0][2]*m[2][0]) * inv;
+        r.m[1][2] = -(m[0][0]*m[1][2] - m[0][2]*m[1][0]) * inv;
+        r.m[2][0] =  (m[1][0]*m[2][1] - m[1][1]*m[2][0]) * inv;
+        r.m[2][1] = -(m[0][0]*m[2][1] - m[0][1]*m[2][0]) * inv;
+        r.m[2][2] =  (m[0][0]*m[1][1] - m[0][1]*m[1][0]) * inv;
+        return r;
+    }
+};
+
+/**
+ * transformação afim p' = M p + t
+ * guarda também a inversa, que é o que o raio usa
+ * para ir do espaço do mundo para o espaço do objeto
+ */
+class transform {
+  public:
+    mat3 linear;
+    vec3 translacao;
+    mat3 inv_linear;
+
+    transform() {}
+
+    transform(const mat3& M, const vec3& t)
+      : linear(M), translacao(t), inv_linear(M.inversa()) {}
+
+    static transform translate(const vec3& t) {
+        return transform(mat3(), t);
+    }
+
+    static transform scale(double sx, double sy, double sz) {
+        mat3 M;
+        M.m[0][0] = sx; M.m[1][1] = sy; M.m[2][2] = sz;
+        return transform(M, vec3());
+    }
+
+    // rotação de 'angulo' radianos em torno de 'eixo' (fórmula de Rodrigues)
+    static transform rotate(const vec3& eixo, double angulo) {
+        vec3 k = unit_vector(eixo);
+        double c = std::cos(angulo), s = std::sin(angulo), t = 1 - c;
+        mat3 M;
+        M.m[0][0] = c + k.x()*k.x()*t;        M.m[0][1] = k.x()*k.y()*t - k.z()*s;  M.m[0][2] = k.x()*k.z()*t + k.y()*s;
+        M.m[1][0] = k.y()*k.x()*t + k.z()*s;  M.m[1][1] = c + k.y()*k.y()*t;        M.m[1][2] = k.y()*k.z()*t - k.x()*s;
+        M.m[2][0] = k.z()*k.x()*t - k.y()*s;  M.m[2][1] = k.z()*k.y()*t + k.x()*s;  M.m[2][2] = c + k.z()*k.z()*t;
+        return transform(M, vec3());
+    }
+
+    // composição: (a * b)(p) = a(b(p))
+    transform operator*(const transform& b) const {
+        return transform(linear * b.linear, linear * b.translacao + translacao);
+    }
+
+    point3 point(const point3& p) const { return linear * p + translacao; }
+    vec3 vector(const vec3& v) const { return linear * v; }
+
+    // normais usam a transposta da inversa
+    vec3 normal(const vec3& n) const {
+        const auto& m = inv_linear.m;
+        return vec3(
+            m[0][0]*n.x() + m[1][0]*n.y() + m[2][0]*n.z(),
+            m[0][1]*n.x() + m[1][1]*n.y() + m[2][1]*n.z(),
+            m[0][2]*n.x() + m[1][2]*n.y() + m[2][2]*n.z()
+        );
+    }
+
+    point3 inv_point(const point3& p) const { return inv_linear * (p - translacao); }
+    vec3 inv_vector(const vec3& v) const { return inv_linear * v; }
+};
+
+#endif
@@ -1,6 +1,8 @@
 #ifndef VEC3_H
 #define VEC3_H
 
+#include "../util/fast_math.h"
+
 #include <cmath>
 #include <iostream>
 
@@ -11,18 +13,18 @@ class vec3 {
     public:
         double e[3];
 
-        vec3() : e{0,0,0} {}
-        vec3(double e0, double e1, double e2) : e{e0, e1, e2} {}
+        constexpr vec3() : e{0,0,0} {}
+        constexpr vec3(double e0, double e1, double e2) : e{e0, e1, e2} {}
 
-        double x() const { return e[0]; }
-        double y() const { return e[1]; }
-        double z() const { return e[2]; }
+        constexpr double x() const { return e[0]; }
+        constexpr double y() const { return e[1]; }
+        constexpr double z() const { return e[2]; }
 
-        vec3 operator-() const {
+        constexpr vec3 operator-() const {
             return vec3(-e[0], -e[1], -e[2]);
         }
 
-        double operator[](int i) const {
+        constexpr double operator[](int i) const {
             return e[i];
         }
 
@@ -54,7 +56,7 @@ class vec3 {
             return std::sqrt(length_squared());
         }
 
-        double length_squared() const {
+        constexpr double length_squared() const {
             return e[0]*e[0] + e[1]*e[1] + e[2]*e[2];
         }
 };
@@ -69,48 +71,64 @@ inline std::ostream& operator<<(std::ostream& out, const vec3& v) {
     return out << v.e[0] << ' ' << v.e[1] << ' ' << v.e[2];
 }
 
-inline vec3 operator+(const vec3& u, const vec3& v) {
+constexpr vec3 operator+(const vec3& u, const vec3& v) {
     return vec3(u.e[0] + v.e[0], u.e[1] + v.e[1], u.e[2] + v.e[2]);
 }
 
-inline vec3 operator-(const vec3& u, const vec3& v) {
+constexpr vec3 operator-(const vec3& u, const vec3& v) {
     return vec3(u.e[0] - v.e[0], u.e[1] - v.e[1], u.e[2] - v.e[2]);
 }
 
 // produto componente de dois vetores
 // não confundir com produto escalar ou produto vetorial
-inline vec3 operator*(const vec3& u, const vec3& v) {
+constexpr vec3 operator*(const vec3& u, const vec3& v) {
    return vec3(u.e[0] * v.e[0], u.e[1] * v.e[1], u.e[2] * v.e[2]);
 }
 
-inline vec3 operator*(double t, const vec3& v) {
+constexpr vec3 operator*(double t, const vec3& v) {
     return vec3(t * v.e[0], t * v.e[1], t * v.e[2]);
 }
 
 // Produto por componente
-inline vec3 operator*(const vec3& v, double t) {
+constexpr vec3 operator*(const vec3& v, double t) {
     return t * v;
 }
 
-inline vec3 operator/(const vec3& v, double t) {
+constexpr vec3 operator/(const vec3& v, double t) {
     return (1/t) * v;
 }
 
 // O produto escalar de dois vetores
-inline double dot(const vec3& u, const vec3& v) {
+constexpr double dot(const vec3& u, const vec3& v) {
     return u.e[0] * v.e[0] + u.e[1] * v.e[1] + u.e[2] * v.e[2];
 }
 
 // Produto vetorial
-inline vec3 cross(const vec3& u, const vec3& v) {
+constexpr vec3 cross(const vec3& u, const vec3& v) {
     return vec3(u.e[1] * v.e[2] - u.e[2] * v.e[1],
         u.e[2] * v.e[0] - u.e[0] * v.e[2],
         u.e[0] * v.e[1] - u.e[1] * v.e[0]
     );
 }
 
+// no modo rápido (fast_math.h), com rsqrt no lugar de sqrt e divisão
 inline vec3 unit_vector(const vec3& v) {
+    if constexpr (fast_math) return v * rsqrt(v.length_squared());
     return v / v.length();
 }
 
+// reflete v em torno de n
+inline vec3 reflect(const vec3& v, const vec3& n) {
+    return v - 2 * dot(v,n) * n;
+}
+
+// refração de uv (unitário) pela lei de Snell, n contra uv,
+// eta = n_origem / n_destino
+inline vec3 refract(const vec3& uv, const vec3& n, double eta) {
+    double cos_theta = std::fmin(dot(-uv, n), 1.0);
+    vec3 perp = eta * (uv + cos_theta * n);
+    vec3 paralelo = -std::sqrt(std::fabs(1.0 - perp.length_squared())) * n;
+    return perp + paralelo;
+}
+
 #endif
\ No newline at end of file